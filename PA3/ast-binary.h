@@ -0,0 +1,8 @@
+//
+// ast-binary.h
+//
+// The binary AST format is shared with the semantic analyzer, which reads
+// back what the parser writes, so it has one definition, in
+// PA4/ast-binary.h.
+//
+#include "../PA4/ast-binary.h"
@@ -0,0 +1,53 @@
+/*
+ * binary-parser-phase.cc
+ *          Parser driver that writes the binary AST.
+ *
+ * Like parser-phase.cc, this reads a token stream from standard input, but
+ * the AST is written to standard output in the binary format described in
+ * ast-binary.h rather than as dump_with_types text. The semantic analyzer's
+ * binary-semant-phase reads it back.
+ *
+ * Build it from the objects of `make parser', substituting this file for
+ * parser-phase.o, e.g.
+ *
+ *      g++ -g -Wall -Wno-unused -Wno-write-strings -I. \
+ *          -I/usr/class/cs143/cool/include/PA3 -I/usr/class/cs143/cool/src/PA3 \
+ *          binary-parser-phase.cc cool-parse.o tokens-lex.o handle_flags.o \
+ *          utilities.o stringtab.o tree.o cool-tree.o dumptype.o \
+ *          -o binary-parser
+ *
+ * and run it as
+ *
+ *      lexer foo.cl | binary-parser | binary-semant > foo.ast
+ */
+#include <stdio.h>
+#include "cool-io.h"
+#include "cool-tree.h"
+#include "utilities.h"
+#include "cool-parse.h"
+
+//
+// Globals normally provided by parser-phase.cc.
+//
+FILE *token_file = stdin;       // we read from this file
+extern Classes parse_results;   // list of classes; used for multiple files
+extern Program ast_root;        // the AST produced by the parse
+
+char *curr_filename = "<stdin>";
+
+extern int omerrs;              // a count of lex and parse errors
+extern int cool_yyparse();
+void handle_flags(int argc, char *argv[]);
+
+int main(int argc, char *argv[]) {
+    handle_flags(argc, argv);
+    cool_yyparse();
+    if (omerrs != 0) {
+        cerr << "Compilation halted due to lex and parse errors\n";
+        exit(1);
+    }
+    ast_writer writer;
+    ast_root->dump_binary(writer);
+    writer.finish(cout);
+    return 0;
+}
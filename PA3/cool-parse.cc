@@ -1,23 +1,22 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* A Bison parser, made by GNU Bison 2.4.1.  */
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-/* Skeleton implementation for Bison's Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
-   
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -28,13 +27,17 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -42,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "2.4.1"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -60,25 +63,23 @@
 /* Pull parsers.  */
 #define YYPULL 1
 
-/* Using locations.  */
-#define YYLSP_NEEDED 1
 
 /* Substitute the variable and function names.  */
 #define yyparse         cool_yyparse
 #define yylex           cool_yylex
 #define yyerror         cool_yyerror
-#define yylval          cool_yylval
-#define yychar          cool_yychar
 #define yydebug         cool_yydebug
 #define yynerrs         cool_yynerrs
+#define yylval          cool_yylval
+#define yychar          cool_yychar
 #define yylloc          cool_yylloc
 
-/* Copy the first part of user declarations.  */
-
-/* Line 189 of yacc.c  */
+/* First part of user prologue.  */
 #line 6 "cool.y"
 
   #include <iostream>
+  #include <vector>
+  #include <algorithm>
   #include "cool-tree.h"
   #include "stringtab.h"
   #include "utilities.h"
@@ -88,6 +89,9 @@
   
   /* Locations */
   #define YYLTYPE int              /* the type of locations */
+  #define YYMAXDEPTH 10000         /* the stacks start at bison's default
+  depth and grow up to this (see grow_parser_stacks) */
+  #define yyoverflow grow_parser_stacks
   #define cool_yylloc curr_lineno  /* use the curr_lineno from the lexer
   for the location of tokens */
     
@@ -151,6 +155,61 @@
     void yyerror(char *s);        /*  defined below; called for each parse error */
     extern int yylex();           /*  the entry point to the lexer  */
     
+    /* Bison only grows its stacks itself in C++ if YYLTYPE is a struct,
+    which ours is not, so yyoverflow does it instead. Each stack doubles,
+    up to YYMAXDEPTH, into storage that is kept for the next parse. If the
+    stacks are full the size is left alone and the parse is aborted. */
+    template <int Stack, class T>
+    static void grow_parser_stack(T **stack, size_t used_bytes, size_t depth)
+    {
+      static std::vector<T> storage;
+      std::vector<T> grown(depth);
+      std::copy(*stack, *stack + used_bytes / sizeof(T), grown.begin());
+      storage.swap(grown);
+      *stack = &storage[0];
+    }
+    
+    template <class State, class Value, class Location, class Size>
+    static void grow_parser_stacks(const char *message,
+    State **states, size_t states_bytes,
+    Value **values, size_t values_bytes,
+    Location **locations, size_t locations_bytes,
+    Size *depth)
+    {
+      if (*depth >= YYMAXDEPTH) {
+        yyerror((char *) message);
+        return;
+      }
+      *depth = std::min<Size>(*depth * 2, YYMAXDEPTH);
+      grow_parser_stack<0>(states, states_bytes, *depth);
+      grow_parser_stack<1>(values, values_bytes, *depth);
+      grow_parser_stack<2>(locations, locations_bytes, *depth);
+    }
+    
+    /* Let bindings are collected left to right on an explicit stack instead
+    * of through a right-recursive rule, so a let with thousands of bindings
+    * doesn't grow the bison stack. Each let records where its bindings start
+    * (let_frames); nested lets inside initializers push and pop their own
+    * frames before the enclosing binding is pushed. Once the body is parsed
+    * the usual chain of nested let nodes is built from the inside out. A
+    * let_list thrown away by error recovery drops its frame (see the
+    * %destructor below), so the frames always match the open lets.
+    */
+    struct let_binding_t {
+      Symbol identifier;
+      Symbol type_decl;
+      Expression init;
+      int lineno;
+    };
+    static std::vector<let_binding_t> let_bindings;
+    static std::vector<size_t> let_frames;
+    
+    static void push_let_binding(Symbol identifier, Symbol type_decl,
+    Expression init, int lineno);
+    static Boolean push_let_frame();
+    static Expression build_let_chain(Boolean let_list, Expression body);
+    static void discard_let_frame();
+    
     /************************************************************************/
     /*                DONT CHANGE ANYTHING IN THIS SECTION                  */
     
@@ -159,174 +218,186 @@
     int omerrs = 0;               /* number of errors in lexing and parsing */
     
 
-/* Line 189 of yacc.c  */
-#line 164 "cool.tab.c"
-
-/* Enabling traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 1
-#endif
-
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* Enabling the token table.  */
-#ifndef YYTOKEN_TABLE
-# define YYTOKEN_TABLE 0
-#endif
+#line 222 "cool.tab.c"
 
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
 
-/* Tokens.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     CLASS = 258,
-     ELSE = 259,
-     FI = 260,
-     IF = 261,
-     IN = 262,
-     INHERITS = 263,
-     LET = 264,
-     LOOP = 265,
-     POOL = 266,
-     THEN = 267,
-     WHILE = 268,
-     CASE = 269,
-     ESAC = 270,
-     OF = 271,
-     DARROW = 272,
-     NEW = 273,
-     ISVOID = 274,
-     STR_CONST = 275,
-     INT_CONST = 276,
-     BOOL_CONST = 277,
-     TYPEID = 278,
-     OBJECTID = 279,
-     ASSIGN = 280,
-     NOT = 281,
-     LE = 282,
-     ERROR = 283
-   };
-#endif
-/* Tokens.  */
-#define CLASS 258
-#define ELSE 259
-#define FI 260
-#define IF 261
-#define IN 262
-#define INHERITS 263
-#define LET 264
-#define LOOP 265
-#define POOL 266
-#define THEN 267
-#define WHILE 268
-#define CASE 269
-#define ESAC 270
-#define OF 271
-#define DARROW 272
-#define NEW 273
-#define ISVOID 274
-#define STR_CONST 275
-#define INT_CONST 276
-#define BOOL_CONST 277
-#define TYPEID 278
-#define OBJECTID 279
-#define ASSIGN 280
-#define NOT 281
-#define LE 282
-#define ERROR 283
-
-
-
-
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
+#include "cool.tab.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_CLASS = 3,                      /* CLASS  */
+  YYSYMBOL_ELSE = 4,                       /* ELSE  */
+  YYSYMBOL_FI = 5,                         /* FI  */
+  YYSYMBOL_IF = 6,                         /* IF  */
+  YYSYMBOL_IN = 7,                         /* IN  */
+  YYSYMBOL_INHERITS = 8,                   /* INHERITS  */
+  YYSYMBOL_LET = 9,                        /* LET  */
+  YYSYMBOL_LOOP = 10,                      /* LOOP  */
+  YYSYMBOL_POOL = 11,                      /* POOL  */
+  YYSYMBOL_THEN = 12,                      /* THEN  */
+  YYSYMBOL_WHILE = 13,                     /* WHILE  */
+  YYSYMBOL_CASE = 14,                      /* CASE  */
+  YYSYMBOL_ESAC = 15,                      /* ESAC  */
+  YYSYMBOL_OF = 16,                        /* OF  */
+  YYSYMBOL_DARROW = 17,                    /* DARROW  */
+  YYSYMBOL_NEW = 18,                       /* NEW  */
+  YYSYMBOL_ISVOID = 19,                    /* ISVOID  */
+  YYSYMBOL_STR_CONST = 20,                 /* STR_CONST  */
+  YYSYMBOL_INT_CONST = 21,                 /* INT_CONST  */
+  YYSYMBOL_BOOL_CONST = 22,                /* BOOL_CONST  */
+  YYSYMBOL_TYPEID = 23,                    /* TYPEID  */
+  YYSYMBOL_OBJECTID = 24,                  /* OBJECTID  */
+  YYSYMBOL_ASSIGN = 25,                    /* ASSIGN  */
+  YYSYMBOL_NOT = 26,                       /* NOT  */
+  YYSYMBOL_LE = 27,                        /* LE  */
+  YYSYMBOL_ERROR = 28,                     /* ERROR  */
+  YYSYMBOL_29_ = 29,                       /* '<'  */
+  YYSYMBOL_30_ = 30,                       /* '='  */
+  YYSYMBOL_31_ = 31,                       /* '+'  */
+  YYSYMBOL_32_ = 32,                       /* '-'  */
+  YYSYMBOL_33_ = 33,                       /* '*'  */
+  YYSYMBOL_34_ = 34,                       /* '/'  */
+  YYSYMBOL_35_ = 35,                       /* '~'  */
+  YYSYMBOL_36_ = 36,                       /* '@'  */
+  YYSYMBOL_37_ = 37,                       /* '.'  */
+  YYSYMBOL_38_ = 38,                       /* '{'  */
+  YYSYMBOL_39_ = 39,                       /* '}'  */
+  YYSYMBOL_40_ = 40,                       /* ';'  */
+  YYSYMBOL_41_ = 41,                       /* '('  */
+  YYSYMBOL_42_ = 42,                       /* ')'  */
+  YYSYMBOL_43_ = 43,                       /* ':'  */
+  YYSYMBOL_44_ = 44,                       /* ','  */
+  YYSYMBOL_YYACCEPT = 45,                  /* $accept  */
+  YYSYMBOL_program = 46,                   /* program  */
+  YYSYMBOL_class_list = 47,                /* class_list  */
+  YYSYMBOL_class = 48,                     /* class  */
+  YYSYMBOL_feature_list = 49,              /* feature_list  */
+  YYSYMBOL_feature = 50,                   /* feature  */
+  YYSYMBOL_formal_list = 51,               /* formal_list  */
+  YYSYMBOL_formal = 52,                    /* formal  */
+  YYSYMBOL_expr_list_dispatch = 53,        /* expr_list_dispatch  */
+  YYSYMBOL_expr_list_block = 54,           /* expr_list_block  */
+  YYSYMBOL_expr = 55,                      /* expr  */
+  YYSYMBOL_let_list = 56,                  /* let_list  */
+  YYSYMBOL_let_binding = 57,               /* let_binding  */
+  YYSYMBOL_let_errors = 58,                /* let_errors  */
+  YYSYMBOL_case_list = 59,                 /* case_list  */
+  YYSYMBOL_case = 60                       /* case  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-/* Line 214 of yacc.c  */
-#line 89 "cool.y"
-
-      Boolean boolean;
-      Symbol symbol;
-      Program program;
-      Class_ class_;
-      Classes classes;
-      Feature feature;
-      Features features;
-      Formal formal;
-      Formals formals;
-      Case case_;
-      Cases cases;
-      Expression expression;
-      Expressions expressions;
-      char *error_msg;
-    
 
 
-/* Line 214 of yacc.c  */
-#line 275 "cool.tab.c"
-} YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
-#endif
 
-#if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
-typedef struct YYLTYPE
-{
-  int first_line;
-  int first_column;
-  int last_line;
-  int last_column;
-} YYLTYPE;
-# define yyltype YYLTYPE /* obsolescent; will be withdrawn */
-# define YYLTYPE_IS_DECLARED 1
-# define YYLTYPE_IS_TRIVIAL 1
+#ifdef short
+# undef short
 #endif
 
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
 
-/* Copy the second part of user declarations.  */
-
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
 
-/* Line 264 of yacc.c  */
-#line 300 "cool.tab.c"
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
 
-#ifdef short
-# undef short
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef unsigned char yytype_uint8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#elif (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-typedef signed char yytype_int8;
-#else
-typedef short int yytype_int8;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -334,55 +405,106 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
-# if YYENABLE_NLS
+# if defined YYENABLE_NLS && YYENABLE_NLS
 #  if ENABLE_NLS
 #   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
-#   define YY_(msgid) dgettext ("bison-runtime", msgid)
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
 #  endif
 # endif
 # ifndef YY_
-#  define YY_(msgid) msgid
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(e) ((void) (e))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(e) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-/* Identity function, used to suppress warnings about constant conditions.  */
-#ifndef lint
-# define YYID(n) (n)
-#else
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static int
-YYID (int yyi)
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
 #else
-static int
-YYID (yyi)
-    int yyi;
+# define YY_INITIAL_VALUE(Value) Value
 #endif
-{
-  return yyi;
-}
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -399,11 +521,11 @@ YYID (yyi)
 #    define alloca _alloca
 #   else
 #    define YYSTACK_ALLOC alloca
-#    if ! defined _ALLOCA_H && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
 #     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#     ifndef _STDLIB_H
-#      define _STDLIB_H 1
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
 #     endif
 #    endif
 #   endif
@@ -411,8 +533,8 @@ YYID (yyi)
 # endif
 
 # ifdef YYSTACK_ALLOC
-   /* Pacify GCC's `empty if-body' warning.  */
-#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (YYID (0))
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
     /* The OS might guarantee only one guard page at the bottom of the stack,
        and a page size can be as small as 4096 bytes.  So we cannot safely
@@ -426,113 +548,120 @@ YYID (yyi)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
 #   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
 #  endif
-#  if (defined __cplusplus && ! defined _STDLIB_H \
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
        && ! ((defined YYMALLOC || defined malloc) \
-	     && (defined YYFREE || defined free)))
+             && (defined YYFREE || defined free)))
 #   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#   ifndef _STDLIB_H
-#    define _STDLIB_H 1
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
 #   endif
 #  endif
 #  ifndef YYMALLOC
 #   define YYMALLOC malloc
-#   if ! defined malloc && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined malloc && ! defined EXIT_SUCCESS
 void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 #  ifndef YYFREE
 #   define YYFREE free
-#   if ! defined free && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined free && ! defined EXIT_SUCCESS
 void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-	 || (defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL \
-	     && defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL \
+             && defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
   YYLTYPE yyls_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE) + sizeof (YYLTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
       + 2 * YYSTACK_GAP_MAXIMUM)
 
-/* Copy COUNT objects from FROM to TO.  The source and destination do
-   not overlap.  */
-# ifndef YYCOPY
-#  if defined __GNUC__ && 1 < __GNUC__
-#   define YYCOPY(To, From, Count) \
-      __builtin_memcpy (To, From, (Count) * sizeof (*(From)))
-#  else
-#   define YYCOPY(To, From, Count)		\
-      do					\
-	{					\
-	  YYSIZE_T yyi;				\
-	  for (yyi = 0; yyi < (Count); yyi++)	\
-	    (To)[yyi] = (From)[yyi];		\
-	}					\
-      while (YYID (0))
-#  endif
-# endif
+# define YYCOPY_NEEDED 1
 
 /* Relocate STACK from its old location to the new one.  The
    local variables YYSIZE and YYSTACKSIZE give the old and new number of
    elements in the stack, and YYPTR gives the new location of the
    stack.  Advance YYPTR to a properly aligned location for the next
    stack.  */
-# define YYSTACK_RELOCATE(Stack_alloc, Stack)				\
-    do									\
-      {									\
-	YYSIZE_T yynewbytes;						\
-	YYCOPY (&yyptr->Stack_alloc, Stack, yysize);			\
-	Stack = &yyptr->Stack_alloc;					\
-	yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-	yyptr += yynewbytes / sizeof (*yyptr);				\
-      }									\
-    while (YYID (0))
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
 
 #endif
 
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  7
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   415
+#define YYLAST   395
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  45
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  14
+#define YYNNTS  16
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  58
-/* YYNRULES -- Number of states.  */
-#define YYNSTATES  156
+#define YYNRULES  61
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  158
 
-/* YYTRANSLATE(YYLEX) -- Bison symbol number corresponding to YYLEX.  */
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   284
 
-#define YYTRANSLATE(YYX)						\
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
 
-/* YYTRANSLATE[YYLEX] -- Bison symbol number corresponding to YYLEX.  */
-static const yytype_uint8 yytranslate[] =
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -566,117 +695,85 @@ static const yytype_uint8 yytranslate[] =
 };
 
 #if YYDEBUG
-/* YYPRHS[YYN] -- Index of the first RHS symbol of rule number YYN in
-   YYRHS.  */
-static const yytype_uint16 yyprhs[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,     0,     3,     5,     7,    10,    17,    26,    31,    32,
-      35,    39,    50,    60,    67,    72,    74,    78,    82,    84,
-      88,    91,    95,    99,   103,   110,   116,   121,   125,   134,
-     142,   150,   156,   160,   163,   169,   172,   175,   179,   183,
-     187,   191,   194,   198,   202,   206,   209,   213,   215,   217,
-     219,   221,   227,   235,   241,   249,   253,   254,   257
+       0,   230,   230,   233,   238,   246,   249,   251,   255,   256,
+     257,   260,   262,   264,   266,   270,   271,   274,   278,   279,
+     283,   284,   285,   288,   289,   291,   293,   295,   297,   299,
+     301,   302,   303,   304,   305,   306,   307,   308,   309,   310,
+     311,   312,   313,   314,   315,   316,   317,   318,   319,   320,
+     321,   326,   327,   328,   329,   332,   334,   338,   339,   342,
+     343,   346
 };
+#endif
 
-/* YYRHS -- A `-1'-separated list of the rules' RHS.  */
-static const yytype_int8 yyrhs[] =
-{
-      46,     0,    -1,    47,    -1,    48,    -1,    47,    48,    -1,
-       3,    23,    38,    49,    39,    40,    -1,     3,    23,     8,
-      23,    38,    49,    39,    40,    -1,     3,     1,    40,    48,
-      -1,    -1,    49,    50,    -1,    49,     1,    40,    -1,    24,
-      41,    51,    42,    43,    23,    38,    55,    39,    40,    -1,
-      24,    41,    42,    43,    23,    38,    55,    39,    40,    -1,
-      24,    43,    23,    25,    55,    40,    -1,    24,    43,    23,
-      40,    -1,    52,    -1,    51,    44,    52,    -1,    24,    43,
-      23,    -1,    55,    -1,    53,    44,    55,    -1,    55,    40,
-      -1,    54,    55,    40,    -1,    54,     1,    40,    -1,    24,
-      25,    55,    -1,    55,    37,    24,    41,    53,    42,    -1,
-      55,    37,    24,    41,    42,    -1,    24,    41,    53,    42,
-      -1,    24,    41,    42,    -1,    55,    36,    23,    37,    24,
-      41,    53,    42,    -1,    55,    36,    23,    37,    24,    41,
-      42,    -1,     6,    55,    12,    55,     4,    55,     5,    -1,
-      13,    55,    10,    55,    11,    -1,    38,    54,    39,    -1,
-       9,    56,    -1,    14,    55,    16,    57,    15,    -1,    18,
-      23,    -1,    19,    55,    -1,    55,    31,    55,    -1,    55,
-      32,    55,    -1,    55,    33,    55,    -1,    55,    34,    55,
-      -1,    35,    55,    -1,    55,    29,    55,    -1,    55,    27,
-      55,    -1,    55,    30,    55,    -1,    26,    55,    -1,    41,
-      55,    42,    -1,    24,    -1,    21,    -1,    20,    -1,    22,
-      -1,    24,    43,    23,     7,    55,    -1,    24,    43,    23,
-      25,    55,     7,    55,    -1,    24,    43,    23,    44,    56,
-      -1,    24,    43,    23,    25,    55,    44,    56,    -1,     1,
-      44,    56,    -1,    -1,    57,    58,    -1,    24,    43,    23,
-      17,    55,    40,    -1
-};
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
 
-/* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
-{
-       0,   165,   165,   168,   173,   181,   184,   186,   190,   191,
-     192,   195,   197,   199,   201,   205,   206,   209,   213,   214,
-     218,   219,   220,   223,   224,   226,   228,   230,   232,   234,
-     236,   237,   238,   239,   240,   241,   242,   243,   244,   245,
-     246,   247,   248,   249,   250,   251,   252,   253,   254,   255,
-     256,   260,   262,   264,   266,   268,   271,   272,   275
-};
-#endif
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 
-#if YYDEBUG || YYERROR_VERBOSE || YYTOKEN_TABLE
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "CLASS", "ELSE", "FI", "IF", "IN",
-  "INHERITS", "LET", "LOOP", "POOL", "THEN", "WHILE", "CASE", "ESAC", "OF",
-  "DARROW", "NEW", "ISVOID", "STR_CONST", "INT_CONST", "BOOL_CONST",
-  "TYPEID", "OBJECTID", "ASSIGN", "NOT", "LE", "ERROR", "'<'", "'='",
-  "'+'", "'-'", "'*'", "'/'", "'~'", "'@'", "'.'", "'{'", "'}'", "';'",
-  "'('", "')'", "':'", "','", "$accept", "program", "class_list", "class",
-  "feature_list", "feature", "formal_list", "formal", "expr_list_dispatch",
-  "expr_list_block", "expr", "expr_let", "case_list", "case", 0
+  "\"end of file\"", "error", "\"invalid token\"", "CLASS", "ELSE", "FI",
+  "IF", "IN", "INHERITS", "LET", "LOOP", "POOL", "THEN", "WHILE", "CASE",
+  "ESAC", "OF", "DARROW", "NEW", "ISVOID", "STR_CONST", "INT_CONST",
+  "BOOL_CONST", "TYPEID", "OBJECTID", "ASSIGN", "NOT", "LE", "ERROR",
+  "'<'", "'='", "'+'", "'-'", "'*'", "'/'", "'~'", "'@'", "'.'", "'{'",
+  "'}'", "';'", "'('", "')'", "':'", "','", "$accept", "program",
+  "class_list", "class", "feature_list", "feature", "formal_list",
+  "formal", "expr_list_dispatch", "expr_list_block", "expr", "let_list",
+  "let_binding", "let_errors", "case_list", "case", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[YYLEX-NUM] -- Internal token number corresponding to
-   token YYLEX-NUM.  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   284,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,    60,
-      61,    43,    45,    42,    47,   126,    64,    46,   123,   125,
-      59,    40,    41,    58,    44
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-/* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
-{
-       0,    45,    46,    47,    47,    48,    48,    48,    49,    49,
-      49,    50,    50,    50,    50,    51,    51,    52,    53,    53,
-      54,    54,    54,    55,    55,    55,    55,    55,    55,    55,
-      55,    55,    55,    55,    55,    55,    55,    55,    55,    55,
-      55,    55,    55,    55,    55,    55,    55,    55,    55,    55,
-      55,    56,    56,    56,    56,    56,    57,    57,    58
-};
+#define YYPACT_NINF (-118)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-/* YYR2[YYN] -- Number of symbols composing right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+#define YYTABLE_NINF (-1)
+
+#define yytable_value_is_error(Yyn) \
+  ((Yyn) == YYTABLE_NINF)
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
 {
-       0,     2,     1,     1,     2,     6,     8,     4,     0,     2,
-       3,    10,     9,     6,     4,     1,     3,     3,     1,     3,
-       2,     3,     3,     3,     6,     5,     4,     3,     8,     7,
-       7,     5,     3,     2,     5,     2,     2,     3,     3,     3,
-       3,     2,     3,     3,     3,     2,     3,     1,     1,     1,
-       1,     5,     7,     5,     7,     3,     0,     2,     6
+      46,     9,    15,    46,  -118,    14,    -4,  -118,  -118,    46,
+      53,  -118,  -118,    26,    11,  -118,    40,   -21,    43,  -118,
+      23,  -118,   -17,    61,  -118,    56,    51,    60,    28,  -118,
+      -2,  -118,    88,    90,    66,    91,   176,  -118,  -118,    76,
+      93,  -118,   176,     2,   176,   176,    94,   176,  -118,  -118,
+    -118,   -11,   176,   176,   176,   176,   277,   176,    81,   240,
+      79,    77,    -5,  -118,     4,   214,   252,  -118,    65,   176,
+      86,   347,    65,    47,   289,   263,   176,   176,   176,   176,
+     176,   176,   176,   103,   107,  -118,   325,   176,   176,  -118,
+     109,   176,     2,    89,  -118,   176,  -118,   347,  -118,    37,
+     347,    99,  -118,   301,  -118,  -118,   358,   358,   358,    41,
+      41,    65,    65,   104,   102,   105,   336,   189,   119,   347,
+    -118,     4,  -118,   227,    12,  -118,   176,  -118,  -118,   122,
+     116,  -118,   108,   176,   176,  -118,  -118,  -118,   106,  -118,
+     347,   112,  -118,    45,  -118,   200,   347,   124,   146,  -118,
+    -118,   133,  -118,    49,   176,  -118,   313,  -118
 };
 
-/* YYDEFACT[STATE-NAME] -- Default rule to reduce with in state
-   STATE-NUM when YYTABLE doesn't specify something else to do.  Zero
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
    means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+static const yytype_int8 yydefact[] =
 {
        0,     0,     0,     2,     3,     0,     0,     1,     4,     0,
        0,     8,     7,     0,     0,     8,     0,     0,     0,     9,
@@ -684,135 +781,106 @@ static const yytype_uint8 yydefact[] =
        0,     6,     0,     0,     0,     0,     0,    14,    17,     0,
        0,    16,     0,     0,     0,     0,     0,     0,    49,    48,
       50,    47,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,    33,     0,     0,    35,    36,     0,     0,    45,
-      41,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,    13,     0,     0,     0,     0,     0,     0,
-      56,    23,    27,     0,    18,     0,    32,     0,    20,    46,
-      43,    42,    44,    37,    38,    39,    40,     0,     0,     0,
-       0,     0,    55,     0,     0,     0,    26,     0,    22,    21,
-       0,     0,    12,     0,     0,     0,     0,     0,    31,    34,
-       0,    57,    19,     0,    25,     0,    11,     0,    51,     0,
-      53,     0,     0,    24,    30,     0,     0,     0,    29,     0,
-      52,    54,     0,    28,     0,    58
+       0,     0,     0,    51,     0,     0,     0,    35,    36,     0,
+       0,    45,    41,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,    13,     0,     0,     0,    57,
+       0,     0,     0,     0,    52,     0,    59,    23,    27,     0,
+      18,     0,    32,     0,    20,    46,    43,    42,    44,    37,
+      38,    39,    40,     0,     0,     0,     0,     0,    55,    33,
+      53,     0,    58,     0,     0,    26,     0,    22,    21,     0,
+       0,    12,     0,     0,     0,    54,    31,    34,     0,    60,
+      19,     0,    25,     0,    11,     0,    56,     0,     0,    24,
+      30,     0,    29,     0,     0,    28,     0,    61
 };
 
-/* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int16 yydefgoto[] =
-{
-      -1,     2,     3,     4,    14,    19,    28,    29,    93,    71,
-      94,    62,   115,   131
-};
-
-/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-   STATE-NUM.  */
-#define YYPACT_NINF -115
-static const yytype_int16 yypact[] =
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int16 yypgoto[] =
 {
-      20,     2,    15,    20,  -115,    -3,    -6,  -115,  -115,    20,
-      44,  -115,  -115,    -4,     9,  -115,    28,    11,    32,  -115,
-      12,  -115,   -20,    62,  -115,    52,    53,    69,    14,  -115,
-     -13,  -115,    70,    76,    71,    89,   210,  -115,  -115,    77,
-      94,  -115,   210,     0,   210,   210,    96,   210,  -115,  -115,
-    -115,   -11,   210,   210,   210,   210,   297,   210,    92,   260,
-      87,    93,  -115,   234,   272,  -115,    23,   210,   120,   367,
-      23,    56,   309,   283,   210,   210,   210,   210,   210,   210,
-     210,   109,   113,  -115,   345,   210,   210,     0,   122,   210,
-    -115,   367,  -115,    19,   367,   103,  -115,   321,  -115,  -115,
-     378,   378,   378,    50,    50,    23,    23,   110,   107,   111,
-     356,   223,  -115,    22,   247,    31,  -115,   210,  -115,  -115,
-     125,   150,  -115,   112,   210,   210,   210,     0,  -115,  -115,
-     114,  -115,   367,   119,  -115,    29,  -115,    74,   367,    91,
-    -115,   127,   180,  -115,  -115,   210,     0,   136,  -115,    58,
-     367,  -115,   210,  -115,   333,  -115
+    -118,  -118,  -118,    54,   141,  -118,  -118,   126,  -117,  -118,
+     -36,  -118,   -63,    70,  -118,  -118
 };
 
-/* YYPGOTO[NTERM-NUM].  */
-static const yytype_int16 yypgoto[] =
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
 {
-    -115,  -115,  -115,    17,   139,  -115,  -115,   130,  -114,  -115,
-     -36,   -82,  -115,  -115
+       0,     2,     3,     4,    14,    19,    28,    29,    99,    73,
+     100,    62,    63,    64,   124,   139
 };
 
-/* YYTABLE[YYPACT[STATE-NUM]].  What to do in state STATE-NUM.  If
-   positive, shift that token.  If negative, reduce the rule which
-   number is the opposite.  If zero, do what YYDEFACT says.
-   If YYTABLE_NINF, syntax error.  */
-#define YYTABLE_NINF -1
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int16 yytable[] =
 {
-      56,    60,    10,     5,    26,   112,    59,   135,    63,    64,
-      16,    66,    36,    16,    67,     7,    69,    70,    72,    73,
-       8,    84,    27,     1,    61,     6,    12,    37,   149,   125,
-      68,    91,    11,    17,    15,    97,    17,     9,   100,   101,
-     102,   103,   104,   105,   106,   140,   129,   126,    18,   110,
-     111,    25,    22,   114,    23,   130,    34,    95,    35,    81,
-      82,   116,    42,   117,   151,    43,   127,    13,    21,    44,
-      45,   143,    24,   117,    46,    47,    48,    49,    50,   144,
-      51,   132,    52,    79,    80,    30,    81,    82,   137,   138,
-     139,    53,    31,    38,    54,    96,    32,    55,   145,    39,
-     153,    74,   117,    75,    76,    77,    78,    79,    80,   150,
-      81,    82,    33,    26,    40,    57,   154,    58,    74,    65,
-      75,    76,    77,    78,    79,    80,    42,    81,    82,    43,
-      85,    87,   107,    44,    45,   146,    88,   108,    46,    47,
-      48,    49,    50,   118,    51,   113,    52,   120,   121,   133,
-     147,   122,   136,   152,    20,    53,    42,   141,    54,    43,
-     142,    55,    92,    44,    45,    41,     0,     0,    46,    47,
-      48,    49,    50,     0,    51,     0,    52,     0,     0,     0,
-       0,     0,     0,     0,     0,    53,    42,     0,    54,    43,
-       0,    55,   134,    44,    45,     0,     0,     0,    46,    47,
-      48,    49,    50,     0,    51,     0,    52,     0,     0,     0,
-       0,     0,     0,     0,     0,    53,    42,     0,    54,    43,
-       0,    55,   148,    44,    45,     0,     0,   124,    46,    47,
-      48,    49,    50,     0,    51,     0,    52,     0,     0,     0,
-       0,     0,     0,     0,    89,    53,     0,     0,    54,     0,
-      74,    55,    75,    76,    77,    78,    79,    80,   128,    81,
-      82,    74,     0,    75,    76,    77,    78,    79,    80,     0,
-      81,    82,    86,     0,    74,     0,    75,    76,    77,    78,
-      79,    80,     0,    81,    82,     0,     0,    74,    90,    75,
-      76,    77,    78,    79,    80,     0,    81,    82,     0,    74,
-       0,    75,    76,    77,    78,    79,    80,     0,    81,    82,
-      74,     0,    75,    76,    77,    78,    79,    80,     0,    81,
-      82,     0,     0,     0,    74,    99,    75,    76,    77,    78,
-      79,    80,     0,    81,    82,     0,    74,    83,    75,    76,
-      77,    78,    79,    80,     0,    81,    82,     0,    74,    98,
-      75,    76,    77,    78,    79,    80,     0,    81,    82,     0,
-      74,   119,    75,    76,    77,    78,    79,    80,     0,    81,
-      82,     0,    74,   155,    75,    76,    77,    78,    79,    80,
-       0,    81,    82,    74,   109,    75,    76,    77,    78,    79,
-      80,     0,    81,    82,    74,   123,    75,    76,    77,    78,
-      79,    80,     0,    81,    82,    -1,     0,    -1,    -1,    77,
-      78,    79,    80,     0,    81,    82
+      56,    94,    91,    60,    10,    93,    59,    26,    65,    66,
+       5,    68,    16,   143,    69,     7,    71,    72,    74,    75,
+      22,    86,    23,    36,    16,    27,    61,   137,    61,   120,
+      70,   153,     6,    97,    11,    17,   138,   103,    37,    92,
+     106,   107,   108,   109,   110,   111,   112,    17,   101,     1,
+      18,   116,   117,    42,     9,   119,    43,     8,   135,   123,
+      44,    45,    25,    12,    15,    46,    47,    48,    49,    50,
+      34,    51,    35,    52,    81,    82,    13,    83,    84,   125,
+      21,   126,    53,    24,    30,    54,   102,   149,    55,   126,
+     140,   155,    42,   126,    32,    43,    31,   145,   146,    44,
+      45,    83,    84,    33,    46,    47,    48,    49,    50,    40,
+      51,    38,    52,    39,    57,    26,    58,    67,   156,    87,
+      90,    53,    42,    89,    54,    43,   113,    55,    98,    44,
+      45,   114,   118,   122,    46,    47,    48,    49,    50,   127,
+      51,   129,    52,   130,   134,   131,   141,   151,   144,   147,
+     154,    53,    42,   148,    54,    43,    20,    55,   142,    44,
+      45,    41,   121,     0,    46,    47,    48,    49,    50,     0,
+      51,     0,    52,     0,     0,     0,     0,     0,     0,     0,
+       0,    53,    42,     0,    54,    43,     0,    55,   152,    44,
+      45,     0,     0,   133,    46,    47,    48,    49,    50,     0,
+      51,     0,    52,     0,     0,   150,     0,     0,     0,     0,
+       0,    53,     0,     0,    54,     0,    76,    55,    77,    78,
+      79,    80,    81,    82,    95,    83,    84,    76,     0,    77,
+      78,    79,    80,    81,    82,     0,    83,    84,   136,     0,
+       0,    76,     0,    77,    78,    79,    80,    81,    82,     0,
+      83,    84,    88,     0,    76,     0,    77,    78,    79,    80,
+      81,    82,     0,    83,    84,     0,     0,    76,    96,    77,
+      78,    79,    80,    81,    82,     0,    83,    84,     0,    76,
+       0,    77,    78,    79,    80,    81,    82,     0,    83,    84,
+      76,     0,    77,    78,    79,    80,    81,    82,     0,    83,
+      84,     0,     0,     0,    76,   105,    77,    78,    79,    80,
+      81,    82,     0,    83,    84,     0,    76,    85,    77,    78,
+      79,    80,    81,    82,     0,    83,    84,     0,    76,   104,
+      77,    78,    79,    80,    81,    82,     0,    83,    84,     0,
+      76,   128,    77,    78,    79,    80,    81,    82,     0,    83,
+      84,     0,    76,   157,    77,    78,    79,    80,    81,    82,
+       0,    83,    84,    76,   115,    77,    78,    79,    80,    81,
+      82,     0,    83,    84,    76,   132,    77,    78,    79,    80,
+      81,    82,     0,    83,    84,    -1,     0,    -1,    -1,    79,
+      80,    81,    82,     0,    83,    84
 };
 
 static const yytype_int16 yycheck[] =
 {
-      36,     1,     8,     1,    24,    87,    42,   121,    44,    45,
-       1,    47,    25,     1,    25,     0,    52,    53,    54,    55,
-       3,    57,    42,     3,    24,    23,     9,    40,   142,     7,
-      41,    67,    38,    24,    38,    71,    24,    40,    74,    75,
-      76,    77,    78,    79,    80,   127,    15,    25,    39,    85,
-      86,    39,    41,    89,    43,    24,    42,     1,    44,    36,
-      37,    42,     6,    44,   146,     9,    44,    23,    40,    13,
-      14,    42,    40,    44,    18,    19,    20,    21,    22,     5,
-      24,   117,    26,    33,    34,    23,    36,    37,   124,   125,
-     126,    35,    40,    23,    38,    39,    43,    41,     7,    23,
-      42,    27,    44,    29,    30,    31,    32,    33,    34,   145,
-      36,    37,    43,    24,    43,    38,   152,    23,    27,    23,
-      29,    30,    31,    32,    33,    34,     6,    36,    37,     9,
-      38,    44,    23,    13,    14,    44,    43,    24,    18,    19,
-      20,    21,    22,    40,    24,    23,    26,    37,    41,    24,
-      23,    40,    40,    17,    15,    35,     6,    43,    38,     9,
-      41,    41,    42,    13,    14,    35,    -1,    -1,    18,    19,
-      20,    21,    22,    -1,    24,    -1,    26,    -1,    -1,    -1,
-      -1,    -1,    -1,    -1,    -1,    35,     6,    -1,    38,     9,
-      -1,    41,    42,    13,    14,    -1,    -1,    -1,    18,    19,
-      20,    21,    22,    -1,    24,    -1,    26,    -1,    -1,    -1,
-      -1,    -1,    -1,    -1,    -1,    35,     6,    -1,    38,     9,
-      -1,    41,    42,    13,    14,    -1,    -1,     4,    18,    19,
-      20,    21,    22,    -1,    24,    -1,    26,    -1,    -1,    -1,
-      -1,    -1,    -1,    -1,    10,    35,    -1,    -1,    38,    -1,
-      27,    41,    29,    30,    31,    32,    33,    34,    11,    36,
-      37,    27,    -1,    29,    30,    31,    32,    33,    34,    -1,
+      36,    64,     7,     1,     8,     1,    42,    24,    44,    45,
+       1,    47,     1,   130,    25,     0,    52,    53,    54,    55,
+      41,    57,    43,    25,     1,    42,    24,    15,    24,    92,
+      41,   148,    23,    69,    38,    24,    24,    73,    40,    44,
+      76,    77,    78,    79,    80,    81,    82,    24,     1,     3,
+      39,    87,    88,     6,    40,    91,     9,     3,   121,    95,
+      13,    14,    39,     9,    38,    18,    19,    20,    21,    22,
+      42,    24,    44,    26,    33,    34,    23,    36,    37,    42,
+      40,    44,    35,    40,    23,    38,    39,    42,    41,    44,
+     126,    42,     6,    44,    43,     9,    40,   133,   134,    13,
+      14,    36,    37,    43,    18,    19,    20,    21,    22,    43,
+      24,    23,    26,    23,    38,    24,    23,    23,   154,    38,
+      43,    35,     6,    44,    38,     9,    23,    41,    42,    13,
+      14,    24,    23,    44,    18,    19,    20,    21,    22,    40,
+      24,    37,    26,    41,    25,    40,    24,    23,    40,    43,
+      17,    35,     6,    41,    38,     9,    15,    41,    42,    13,
+      14,    35,    92,    -1,    18,    19,    20,    21,    22,    -1,
+      24,    -1,    26,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    35,     6,    -1,    38,     9,    -1,    41,    42,    13,
+      14,    -1,    -1,     4,    18,    19,    20,    21,    22,    -1,
+      24,    -1,    26,    -1,    -1,     5,    -1,    -1,    -1,    -1,
+      -1,    35,    -1,    -1,    38,    -1,    27,    41,    29,    30,
+      31,    32,    33,    34,    10,    36,    37,    27,    -1,    29,
+      30,    31,    32,    33,    34,    -1,    36,    37,    11,    -1,
+      -1,    27,    -1,    29,    30,    31,    32,    33,    34,    -1,
       36,    37,    12,    -1,    27,    -1,    29,    30,    31,    32,
       33,    34,    -1,    36,    37,    -1,    -1,    27,    16,    29,
       30,    31,    32,    33,    34,    -1,    36,    37,    -1,    27,
@@ -830,9 +898,9 @@ static const yytype_int16 yycheck[] =
       32,    33,    34,    -1,    36,    37
 };
 
-/* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-   symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
        0,     3,    46,    47,    48,     1,    23,     0,    48,    40,
        8,    38,    48,    23,    49,    38,     1,    24,    39,    50,
@@ -840,107 +908,103 @@ static const yytype_uint8 yystos[] =
       23,    40,    43,    43,    42,    44,    25,    40,    23,    23,
       43,    52,     6,     9,    13,    14,    18,    19,    20,    21,
       22,    24,    26,    35,    38,    41,    55,    38,    23,    55,
-       1,    24,    56,    55,    55,    23,    55,    25,    41,    55,
-      55,    54,    55,    55,    27,    29,    30,    31,    32,    33,
-      34,    36,    37,    40,    55,    38,    12,    44,    43,    10,
-      16,    55,    42,    53,    55,     1,    39,    55,    40,    42,
-      55,    55,    55,    55,    55,    55,    55,    23,    24,    39,
-      55,    55,    56,    23,    55,    57,    42,    44,    40,    40,
-      37,    41,    40,    39,     4,     7,    25,    44,    11,    15,
-      24,    58,    55,    24,    42,    53,    40,    55,    55,    55,
-      56,    43,    41,    42,     5,     7,    44,    23,    42,    53,
-      55,    56,    17,    42,    55,    40
+       1,    24,    56,    57,    58,    55,    55,    23,    55,    25,
+      41,    55,    55,    54,    55,    55,    27,    29,    30,    31,
+      32,    33,    34,    36,    37,    40,    55,    38,    12,    44,
+      43,     7,    44,     1,    57,    10,    16,    55,    42,    53,
+      55,     1,    39,    55,    40,    42,    55,    55,    55,    55,
+      55,    55,    55,    23,    24,    39,    55,    55,    23,    55,
+      57,    58,    44,    55,    59,    42,    44,    40,    40,    37,
+      41,    40,    39,     4,    25,    57,    11,    15,    24,    60,
+      55,    24,    42,    53,    40,    55,    55,    43,    41,    42,
+       5,    23,    42,    53,    17,    42,    55,    40
 };
 
-#define yyerrok		(yyerrstatus = 0)
-#define yyclearin	(yychar = YYEMPTY)
-#define YYEMPTY		(-2)
-#define YYEOF		0
-
-#define YYACCEPT	goto yyacceptlab
-#define YYABORT		goto yyabortlab
-#define YYERROR		goto yyerrorlab
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    45,    46,    47,    47,    48,    48,    48,    49,    49,
+      49,    50,    50,    50,    50,    51,    51,    52,    53,    53,
+      54,    54,    54,    55,    55,    55,    55,    55,    55,    55,
+      55,    55,    55,    55,    55,    55,    55,    55,    55,    55,
+      55,    55,    55,    55,    55,    55,    55,    55,    55,    55,
+      55,    56,    56,    56,    56,    57,    57,    58,    58,    59,
+      59,    60
+};
 
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     1,     2,     6,     8,     4,     0,     2,
+       3,    10,     9,     6,     4,     1,     3,     3,     1,     3,
+       2,     3,     3,     3,     6,     5,     4,     3,     8,     7,
+       7,     5,     3,     4,     5,     2,     2,     3,     3,     3,
+       3,     2,     3,     3,     3,     2,     3,     1,     1,     1,
+       1,     1,     2,     3,     4,     3,     5,     2,     3,     0,
+       2,     6
+};
 
-/* Like YYERROR except do call yyerror.  This remains here temporarily
-   to ease the transition to the new meaning of YYERROR, for GCC.
-   Once GCC version 2 has supplanted version 1, this can go.  */
 
-#define YYFAIL		goto yyerrlab
+enum { YYENOMEM = -2 };
 
-#define YYRECOVERING()  (!!yyerrstatus)
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
 
-#define YYBACKUP(Token, Value)					\
-do								\
-  if (yychar == YYEMPTY && yylen == 1)				\
-    {								\
-      yychar = (Token);						\
-      yylval = (Value);						\
-      yytoken = YYTRANSLATE (yychar);				\
-      YYPOPSTACK (1);						\
-      goto yybackup;						\
-    }								\
-  else								\
-    {								\
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;							\
-    }								\
-while (YYID (0))
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
-#define YYTERROR	1
-#define YYERRCODE	256
+#define YYRECOVERING()  (!!yyerrstatus)
 
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 /* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
    If N is 0, then set CURRENT to the empty location which ends
    the previous symbol: RHS[0] (always defined).  */
 
-#define YYRHSLOC(Rhs, K) ((Rhs)[K])
 #ifndef YYLLOC_DEFAULT
-# define YYLLOC_DEFAULT(Current, Rhs, N)				\
-    do									\
-      if (YYID (N))                                                    \
-	{								\
-	  (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;	\
-	  (Current).first_column = YYRHSLOC (Rhs, 1).first_column;	\
-	  (Current).last_line    = YYRHSLOC (Rhs, N).last_line;		\
-	  (Current).last_column  = YYRHSLOC (Rhs, N).last_column;	\
-	}								\
-      else								\
-	{								\
-	  (Current).first_line   = (Current).last_line   =		\
-	    YYRHSLOC (Rhs, 0).last_line;				\
-	  (Current).first_column = (Current).last_column =		\
-	    YYRHSLOC (Rhs, 0).last_column;				\
-	}								\
-    while (YYID (0))
-#endif
-
-
-/* YY_LOCATION_PRINT -- Print the location on the stream.
-   This macro was not mandated originally: define only if we know
-   we won't break user code: when these are the locations we know.  */
-
-#ifndef YY_LOCATION_PRINT
-# if YYLTYPE_IS_TRIVIAL
-#  define YY_LOCATION_PRINT(File, Loc)			\
-     fprintf (File, "%d.%d-%d.%d",			\
-	      (Loc).first_line, (Loc).first_column,	\
-	      (Loc).last_line,  (Loc).last_column)
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
+# define YYLLOC_DEFAULT(Current, Rhs, N)                                \
+    do                                                                  \
+      if (N)                                                            \
+        {                                                               \
+          (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;        \
+          (Current).first_column = YYRHSLOC (Rhs, 1).first_column;      \
+          (Current).last_line    = YYRHSLOC (Rhs, N).last_line;         \
+          (Current).last_column  = YYRHSLOC (Rhs, N).last_column;       \
+        }                                                               \
+      else                                                              \
+        {                                                               \
+          (Current).first_line   = (Current).last_line   =              \
+            YYRHSLOC (Rhs, 0).last_line;                                \
+          (Current).first_column = (Current).last_column =              \
+            YYRHSLOC (Rhs, 0).last_column;                              \
+        }                                                               \
+    while (0)
 #endif
 
+#define YYRHSLOC(Rhs, K) ((Rhs)[K])
 
-/* YYLEX -- calling `yylex' with the right arguments.  */
-
-#ifdef YYLEX_PARAM
-# define YYLEX yylex (YYLEX_PARAM)
-#else
-# define YYLEX yylex ()
-#endif
 
 /* Enable debugging if requested.  */
 #if YYDEBUG
@@ -950,85 +1014,118 @@ while (YYID (0))
 #  define YYFPRINTF fprintf
 # endif
 
-# define YYDPRINTF(Args)			\
-do {						\
-  if (yydebug)					\
-    YYFPRINTF Args;				\
-} while (YYID (0))
-
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)			  \
-do {									  \
-  if (yydebug)								  \
-    {									  \
-      YYFPRINTF (stderr, "%s ", Title);					  \
-      yy_symbol_print (stderr,						  \
-		  Type, Value, Location); \
-      YYFPRINTF (stderr, "\n");						  \
-    }									  \
-} while (YYID (0))
-
-
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
-
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
-#else
-static void
-yy_symbol_value_print (yyoutput, yytype, yyvaluep, yylocationp)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-    YYLTYPE const * const yylocationp;
-#endif
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+/* YYLOCATION_PRINT -- Print the location on the stream.
+   This macro was not mandated originally: define only if we know
+   we won't break user code: when these are the locations we know.  */
+
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+
+/* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
+
+YY_ATTRIBUTE_UNUSED
+static int
+yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
 {
-  if (!yyvaluep)
-    return;
-  YYUSE (yylocationp);
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# else
-  YYUSE (yyoutput);
-# endif
-  switch (yytype)
+  int res = 0;
+  int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
+  if (0 <= yylocp->first_line)
     {
-      default:
-	break;
+      res += YYFPRINTF (yyo, "%d", yylocp->first_line);
+      if (0 <= yylocp->first_column)
+        res += YYFPRINTF (yyo, ".%d", yylocp->first_column);
+    }
+  if (0 <= yylocp->last_line)
+    {
+      if (yylocp->first_line < yylocp->last_line)
+        {
+          res += YYFPRINTF (yyo, "-%d", yylocp->last_line);
+          if (0 <= end_col)
+            res += YYFPRINTF (yyo, ".%d", end_col);
+        }
+      else if (0 <= end_col && yylocp->first_column < end_col)
+        res += YYFPRINTF (yyo, "-%d", end_col);
     }
+  return res;
 }
 
+#   define YYLOCATION_PRINT  yy_location_print_
+
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, Location); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
-#else
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
 static void
-yy_symbol_print (yyoutput, yytype, yyvaluep, yylocationp)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-    YYLTYPE const * const yylocationp;
-#endif
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
 {
-  if (yytype < YYNTOKENS)
-    YYFPRINTF (yyoutput, "token %s (", yytname[yytype]);
-  else
-    YYFPRINTF (yyoutput, "nterm %s (", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  YY_LOCATION_PRINT (yyoutput, *yylocationp);
-  YYFPRINTF (yyoutput, ": ");
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep, yylocationp);
-  YYFPRINTF (yyoutput, ")");
+  YYLOCATION_PRINT (yyo, yylocationp);
+  YYFPRINTF (yyo, ": ");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -1036,16 +1133,8 @@ yy_symbol_print (yyoutput, yytype, yyvaluep, yylocationp)
 | TOP (included).                                                   |
 `------------------------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
-#else
-static void
-yy_stack_print (yybottom, yytop)
-    yytype_int16 *yybottom;
-    yytype_int16 *yytop;
-#endif
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -1056,64 +1145,57 @@ yy_stack_print (yybottom, yytop)
   YYFPRINTF (stderr, "\n");
 }
 
-# define YY_STACK_PRINT(Bottom, Top)				\
-do {								\
-  if (yydebug)							\
-    yy_stack_print ((Bottom), (Top));				\
-} while (YYID (0))
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
 
 
 /*------------------------------------------------.
 | Report that the YYRULE is going to be reduced.  |
 `------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_reduce_print (YYSTYPE *yyvsp, YYLTYPE *yylsp, int yyrule)
-#else
 static void
-yy_reduce_print (yyvsp, yylsp, yyrule)
-    YYSTYPE *yyvsp;
-    YYLTYPE *yylsp;
-    int yyrule;
-#endif
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule)
 {
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  unsigned long int yylno = yyrline[yyrule];
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
-	     yyrule - 1, yylno);
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
-      yy_symbol_print (stderr, yyrhs[yyprhs[yyrule] + yyi],
-		       &(yyvsp[(yyi + 1) - (yynrhs)])
-		       , &(yylsp[(yyi + 1) - (yynrhs)])		       );
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]));
       YYFPRINTF (stderr, "\n");
     }
 }
 
-# define YY_REDUCE_PRINT(Rule)		\
-do {					\
-  if (yydebug)				\
-    yy_reduce_print (yyvsp, yylsp, Rule); \
-} while (YYID (0))
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, yylsp, Rule); \
+} while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
 
 
 /* YYINITDEPTH -- initial size of the parser's stacks.  */
-#ifndef	YYINITDEPTH
+#ifndef YYINITDEPTH
 # define YYINITDEPTH 200
 #endif
 
@@ -1128,357 +1210,104 @@ int yydebug;
 # define YYMAXDEPTH 10000
 #endif
 
-
 
-#if YYERROR_VERBOSE
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static YYSIZE_T
-yystrlen (const char *yystr)
-#else
-static YYSIZE_T
-yystrlen (yystr)
-    const char *yystr;
-#endif
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-#else
-static char *
-yystpcpy (yydest, yysrc)
-    char *yydest;
-    const char *yysrc;
-#endif
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
 
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
-
-  return yyd - 1;
-}
-#  endif
-# endif
-
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-	switch (*++yyp)
-	  {
-	  case '\'':
-	  case ',':
-	    goto do_not_strip_quotes;
-
-	  case '\\':
-	    if (*++yyp != '\\')
-	      goto do_not_strip_quotes;
-	    /* Fall through.  */
-	  default:
-	    if (yyres)
-	      yyres[yyn] = *yyp;
-	    yyn++;
-	    break;
-
-	  case '"':
-	    if (yyres)
-	      yyres[yyn] = '\0';
-	    return yyn;
-	  }
-    do_not_strip_quotes: ;
-    }
-
-  if (! yyres)
-    return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
-
-/* Copy into YYRESULT an error message about the unexpected token
-   YYCHAR while in state YYSTATE.  Return the number of bytes copied,
-   including the terminating null byte.  If YYRESULT is null, do not
-   copy anything; just return the number of bytes that would be
-   copied.  As a special case, return 0 if an ordinary "syntax error"
-   message will do.  Return YYSIZE_MAXIMUM if overflow occurs during
-   size calculation.  */
-static YYSIZE_T
-yysyntax_error (char *yyresult, int yystate, int yychar)
-{
-  int yyn = yypact[yystate];
-
-  if (! (YYPACT_NINF < yyn && yyn <= YYLAST))
-    return 0;
-  else
-    {
-      int yytype = YYTRANSLATE (yychar);
-      YYSIZE_T yysize0 = yytnamerr (0, yytname[yytype]);
-      YYSIZE_T yysize = yysize0;
-      YYSIZE_T yysize1;
-      int yysize_overflow = 0;
-      enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-      char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-      int yyx;
-
-# if 0
-      /* This is so xgettext sees the translatable formats that are
-	 constructed on the fly.  */
-      YY_("syntax error, unexpected %s");
-      YY_("syntax error, unexpected %s, expecting %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s");
-# endif
-      char *yyfmt;
-      char const *yyf;
-      static char const yyunexpected[] = "syntax error, unexpected %s";
-      static char const yyexpecting[] = ", expecting %s";
-      static char const yyor[] = " or %s";
-      char yyformat[sizeof yyunexpected
-		    + sizeof yyexpecting - 1
-		    + ((YYERROR_VERBOSE_ARGS_MAXIMUM - 2)
-		       * (sizeof yyor - 1))];
-      char const *yyprefix = yyexpecting;
-
-      /* Start YYX at -YYN if negative to avoid negative indexes in
-	 YYCHECK.  */
-      int yyxbegin = yyn < 0 ? -yyn : 0;
-
-      /* Stay within bounds of both yycheck and yytname.  */
-      int yychecklim = YYLAST - yyn + 1;
-      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-      int yycount = 1;
-
-      yyarg[0] = yytname[yytype];
-      yyfmt = yystpcpy (yyformat, yyunexpected);
-
-      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-	if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR)
-	  {
-	    if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-	      {
-		yycount = 1;
-		yysize = yysize0;
-		yyformat[sizeof yyunexpected - 1] = '\0';
-		break;
-	      }
-	    yyarg[yycount++] = yytname[yyx];
-	    yysize1 = yysize + yytnamerr (0, yytname[yyx]);
-	    yysize_overflow |= (yysize1 < yysize);
-	    yysize = yysize1;
-	    yyfmt = yystpcpy (yyfmt, yyprefix);
-	    yyprefix = yyor;
-	  }
-
-      yyf = YY_(yyformat);
-      yysize1 = yysize + yystrlen (yyf);
-      yysize_overflow |= (yysize1 < yysize);
-      yysize = yysize1;
-
-      if (yysize_overflow)
-	return YYSIZE_MAXIMUM;
-
-      if (yyresult)
-	{
-	  /* Avoid sprintf, as that infringes on the user's name space.
-	     Don't have undefined behavior even if the translation
-	     produced a string with the wrong number of "%s"s.  */
-	  char *yyp = yyresult;
-	  int yyi = 0;
-	  while ((*yyp = *yyf) != '\0')
-	    {
-	      if (*yyp == '%' && yyf[1] == 's' && yyi < yycount)
-		{
-		  yyp += yytnamerr (yyp, yyarg[yyi++]);
-		  yyf += 2;
-		}
-	      else
-		{
-		  yyp++;
-		  yyf++;
-		}
-	    }
-	}
-      return yysize;
-    }
-}
-#endif /* YYERROR_VERBOSE */
-
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocationp)
-#else
 static void
-yydestruct (yymsg, yytype, yyvaluep, yylocationp)
-    const char *yymsg;
-    int yytype;
-    YYSTYPE *yyvaluep;
-    YYLTYPE *yylocationp;
-#endif
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp)
 {
-  YYUSE (yyvaluep);
-  YYUSE (yylocationp);
-
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
-  switch (yytype)
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  switch (yykind)
     {
+    case YYSYMBOL_let_list: /* let_list  */
+#line 212 "cool.y"
+                { discard_let_frame(); }
+#line 1239 "cool.tab.c"
+        break;
 
       default:
-	break;
+        break;
     }
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
-/* Prevent warnings from -Wmissing-prototypes.  */
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
-#else
-int yyparse ();
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void);
-#else
-int yyparse ();
-#endif
-#endif /* ! YYPARSE_PARAM */
 
-
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 /* The semantic value of the lookahead symbol.  */
 YYSTYPE yylval;
-
 /* Location data for the lookahead symbol.  */
-YYLTYPE yylloc;
-
+YYLTYPE yylloc
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+  = { 1, 1, 1, 1 }
+# endif
+;
 /* Number of syntax errors so far.  */
 int yynerrs;
 
 
 
-/*-------------------------.
-| yyparse or yypush_parse.  |
-`-------------------------*/
 
-#ifdef YYPARSE_PARAM
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void *YYPARSE_PARAM)
-#else
-int
-yyparse (YYPARSE_PARAM)
-    void *YYPARSE_PARAM;
-#endif
-#else /* ! YYPARSE_PARAM */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+/*----------.
+| yyparse.  |
+`----------*/
+
 int
 yyparse (void)
-#else
-int
-yyparse ()
-
-#endif
-#endif
 {
-
-
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
+    int yyerrstatus = 0;
 
-    /* The stacks and their tools:
-       `yyss': related to states.
-       `yyvs': related to semantic values.
-       `yyls': related to locations.
-
-       Refer to the stacks thru separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    /* The semantic value stack.  */
+    /* The semantic value stack: array, bottom, top.  */
     YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
-    /* The location stack.  */
+    /* The location stack: array, bottom, top.  */
     YYLTYPE yylsa[YYINITDEPTH];
-    YYLTYPE *yyls;
-    YYLTYPE *yylsp;
-
-    /* The locations where the error started and ended.  */
-    YYLTYPE yyerror_range[2];
-
-    YYSIZE_T yystacksize;
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
   YYLTYPE yyloc;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
+
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
 
@@ -1486,146 +1315,147 @@ yyparse ()
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yytoken = 0;
-  yyss = yyssa;
-  yyvs = yyvsa;
-  yyls = yylsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
 
-  /* Initialize stack pointers.
-     Waste one element of value and location stack
-     so that they stay on the same level as the state stack.
-     The wasted elements are never initialized.  */
-  yyssp = yyss;
-  yyvsp = yyvs;
-  yylsp = yyls;
-
-#if YYLTYPE_IS_TRIVIAL
-  /* Initialize the default location before parsing starts.  */
-  yylloc.first_line   = yylloc.last_line   = 1;
-  yylloc.first_column = yylloc.last_column = 1;
-#endif
-
+  yylsp[0] = yylloc;
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
-	/* Give user a chance to reallocate the stack.  Use copies of
-	   these so that the &'s don't force the real ones into
-	   memory.  */
-	YYSTYPE *yyvs1 = yyvs;
-	yytype_int16 *yyss1 = yyss;
-	YYLTYPE *yyls1 = yyls;
-
-	/* Each stack pointer address is followed by the size of the
-	   data in use in that stack, in bytes.  This used to be a
-	   conditional around just the two extra args, but that might
-	   be undefined if yyoverflow is a macro.  */
-	yyoverflow (YY_("memory exhausted"),
-		    &yyss1, yysize * sizeof (*yyssp),
-		    &yyvs1, yysize * sizeof (*yyvsp),
-		    &yyls1, yysize * sizeof (*yylsp),
-		    &yystacksize);
-
-	yyls = yyls1;
-	yyss = yyss1;
-	yyvs = yyvs1;
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+        YYLTYPE *yyls1 = yyls;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+        yyls = yyls1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-	goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
-	yystacksize = YYMAXDEPTH;
+        yystacksize = YYMAXDEPTH;
 
       {
-	yytype_int16 *yyss1 = yyss;
-	union yyalloc *yyptr =
-	  (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
-	if (! yyptr)
-	  goto yyexhaustedlab;
-	YYSTACK_RELOCATE (yyss_alloc, yyss);
-	YYSTACK_RELOCATE (yyvs_alloc, yyvs);
-	YYSTACK_RELOCATE (yyls_alloc, yyls);
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        YYSTACK_RELOCATE (yyls_alloc, yyls);
 #  undef YYSTACK_RELOCATE
-	if (yyss1 != yyssa)
-	  YYSTACK_FREE (yyss1);
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
       yylsp = yyls + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-		  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
-	YYABORT;
+        YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
   /* First try to decide what to do without reference to lookahead token.  */
   yyn = yypact[yystate];
-  if (yyn == YYPACT_NINF)
+  if (yypact_value_is_default (yyn))
     goto yydefault;
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = YYLEX;
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1640,8 +1470,8 @@ yybackup:
   yyn = yytable[yyn];
   if (yyn <= 0)
     {
-      if (yyn == 0 || yyn == YYTABLE_NINF)
-	goto yyerrlab;
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
       yyn = -yyn;
       goto yyreduce;
     }
@@ -1653,13 +1483,14 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
   *++yylsp = yylloc;
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1674,14 +1505,14 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
   yylen = yyr2[yyn];
 
   /* If YYLEN is nonzero, implement the default value of the action:
-     `$$ = $1'.
+     '$$ = $1'.
 
      Otherwise, the following line sets YYVAL to garbage.
      This behavior is undocumented and Bison
@@ -1690,497 +1521,425 @@ yyreduce:
      GCC warning that YYVAL may be used uninitialized.  */
   yyval = yyvsp[1-yylen];
 
-  /* Default location.  */
+  /* Default location. */
   YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+  yyerror_range[1] = yyloc;
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-
-/* Line 1455 of yacc.c  */
-#line 165 "cool.y"
-    { (yyloc) = (yylsp[(1) - (1)]); ast_root = program((yyvsp[(1) - (1)].classes)); }
+  case 2: /* program: class_list  */
+#line 230 "cool.y"
+                        { (yyloc) = (yylsp[0]); ast_root = program((yyvsp[0].classes)); }
+#line 1534 "cool.tab.c"
     break;
 
-  case 3:
-
-/* Line 1455 of yacc.c  */
-#line 169 "cool.y"
-    {
-            (yyval.classes) = single_Classes((yyvsp[(1) - (1)].class_));
+  case 3: /* class_list: class  */
+#line 234 "cool.y"
+        {
+            (yyval.classes) = single_Classes((yyvsp[0].class_));
             parse_results = (yyval.classes);
         }
+#line 1543 "cool.tab.c"
     break;
 
-  case 4:
-
-/* Line 1455 of yacc.c  */
-#line 174 "cool.y"
-    {
-            (yyval.classes) = append_Classes((yyvsp[(1) - (2)].classes), single_Classes((yyvsp[(2) - (2)].class_))); 
+  case 4: /* class_list: class_list class  */
+#line 239 "cool.y"
+        {
+            (yyval.classes) = append_Classes((yyvsp[-1].classes), single_Classes((yyvsp[0].class_))); 
             parse_results = (yyval.classes);
         }
+#line 1552 "cool.tab.c"
     break;
 
-  case 5:
-
-/* Line 1455 of yacc.c  */
-#line 182 "cool.y"
-    { (yyval.class_) = class_((yyvsp[(2) - (6)].symbol), idtable.add_string("Object"),
-                      (yyvsp[(4) - (6)].features), stringtable.add_string(curr_filename)); }
+  case 5: /* class: CLASS TYPEID '{' feature_list '}' ';'  */
+#line 247 "cool.y"
+        { (yyval.class_) = class_((yyvsp[-4].symbol), idtable.add_string("Object"),
+                      (yyvsp[-2].features), stringtable.add_string(curr_filename)); }
+#line 1559 "cool.tab.c"
     break;
 
-  case 6:
-
-/* Line 1455 of yacc.c  */
-#line 185 "cool.y"
-    { (yyval.class_) = class_((yyvsp[(2) - (8)].symbol), (yyvsp[(4) - (8)].symbol), (yyvsp[(6) - (8)].features), stringtable.add_string(curr_filename)); }
+  case 6: /* class: CLASS TYPEID INHERITS TYPEID '{' feature_list '}' ';'  */
+#line 250 "cool.y"
+        { (yyval.class_) = class_((yyvsp[-6].symbol), (yyvsp[-4].symbol), (yyvsp[-2].features), stringtable.add_string(curr_filename)); }
+#line 1565 "cool.tab.c"
     break;
 
-  case 7:
-
-/* Line 1455 of yacc.c  */
-#line 186 "cool.y"
-    { (yyval.class_) = (yyvsp[(4) - (4)].class_); }
+  case 7: /* class: CLASS error ';' class  */
+#line 251 "cool.y"
+                            { (yyval.class_) = (yyvsp[0].class_); }
+#line 1571 "cool.tab.c"
     break;
 
-  case 8:
-
-/* Line 1455 of yacc.c  */
-#line 190 "cool.y"
-    {  (yyval.features) = nil_Features(); }
+  case 8: /* feature_list: %empty  */
+#line 255 "cool.y"
+                {  (yyval.features) = nil_Features(); }
+#line 1577 "cool.tab.c"
     break;
 
-  case 9:
-
-/* Line 1455 of yacc.c  */
-#line 191 "cool.y"
-    { (yyval.features) = append_Features((yyvsp[(1) - (2)].features), single_Features((yyvsp[(2) - (2)].feature))); }
+  case 9: /* feature_list: feature_list feature  */
+#line 256 "cool.y"
+                           { (yyval.features) = append_Features((yyvsp[-1].features), single_Features((yyvsp[0].feature))); }
+#line 1583 "cool.tab.c"
     break;
 
-  case 11:
-
-/* Line 1455 of yacc.c  */
-#line 196 "cool.y"
-    { (yyval.feature) = method((yyvsp[(1) - (10)].symbol), (yyvsp[(3) - (10)].formals), (yyvsp[(6) - (10)].symbol), (yyvsp[(8) - (10)].expression)); }
+  case 11: /* feature: OBJECTID '(' formal_list ')' ':' TYPEID '{' expr '}' ';'  */
+#line 261 "cool.y"
+        { (yyval.feature) = method((yyvsp[-9].symbol), (yyvsp[-7].formals), (yyvsp[-4].symbol), (yyvsp[-2].expression)); }
+#line 1589 "cool.tab.c"
     break;
 
-  case 12:
-
-/* Line 1455 of yacc.c  */
-#line 198 "cool.y"
-    { (yyval.feature) = method((yyvsp[(1) - (9)].symbol), nil_Formals(), (yyvsp[(5) - (9)].symbol), (yyvsp[(7) - (9)].expression)); }
+  case 12: /* feature: OBJECTID '(' ')' ':' TYPEID '{' expr '}' ';'  */
+#line 263 "cool.y"
+        { (yyval.feature) = method((yyvsp[-8].symbol), nil_Formals(), (yyvsp[-4].symbol), (yyvsp[-2].expression)); }
+#line 1595 "cool.tab.c"
     break;
 
-  case 13:
-
-/* Line 1455 of yacc.c  */
-#line 200 "cool.y"
-    { (yyval.feature) = attr((yyvsp[(1) - (6)].symbol), (yyvsp[(3) - (6)].symbol), (yyvsp[(5) - (6)].expression)); }
+  case 13: /* feature: OBJECTID ':' TYPEID ASSIGN expr ';'  */
+#line 265 "cool.y"
+        { (yyval.feature) = attr((yyvsp[-5].symbol), (yyvsp[-3].symbol), (yyvsp[-1].expression)); }
+#line 1601 "cool.tab.c"
     break;
 
-  case 14:
-
-/* Line 1455 of yacc.c  */
-#line 202 "cool.y"
-    { (yyval.feature) = attr((yyvsp[(1) - (4)].symbol), (yyvsp[(3) - (4)].symbol), no_expr()); }
+  case 14: /* feature: OBJECTID ':' TYPEID ';'  */
+#line 267 "cool.y"
+        { (yyval.feature) = attr((yyvsp[-3].symbol), (yyvsp[-1].symbol), no_expr()); }
+#line 1607 "cool.tab.c"
     break;
 
-  case 15:
-
-/* Line 1455 of yacc.c  */
-#line 205 "cool.y"
-    { (yyval.formals) = single_Formals((yyvsp[(1) - (1)].formal)); }
+  case 15: /* formal_list: formal  */
+#line 270 "cool.y"
+           { (yyval.formals) = single_Formals((yyvsp[0].formal)); }
+#line 1613 "cool.tab.c"
     break;
 
-  case 16:
-
-/* Line 1455 of yacc.c  */
-#line 206 "cool.y"
-    { (yyval.formals) = append_Formals((yyvsp[(1) - (3)].formals), single_Formals((yyvsp[(3) - (3)].formal))); }
+  case 16: /* formal_list: formal_list ',' formal  */
+#line 271 "cool.y"
+                             { (yyval.formals) = append_Formals((yyvsp[-2].formals), single_Formals((yyvsp[0].formal))); }
+#line 1619 "cool.tab.c"
     break;
 
-  case 17:
-
-/* Line 1455 of yacc.c  */
-#line 209 "cool.y"
-    { (yyval.formal) = formal((yyvsp[(1) - (3)].symbol), (yyvsp[(3) - (3)].symbol)); }
+  case 17: /* formal: OBJECTID ':' TYPEID  */
+#line 274 "cool.y"
+                        { (yyval.formal) = formal((yyvsp[-2].symbol), (yyvsp[0].symbol)); }
+#line 1625 "cool.tab.c"
     break;
 
-  case 18:
-
-/* Line 1455 of yacc.c  */
-#line 213 "cool.y"
-    { (yyval.expressions) = single_Expressions((yyvsp[(1) - (1)].expression)); }
+  case 18: /* expr_list_dispatch: expr  */
+#line 278 "cool.y"
+         { (yyval.expressions) = single_Expressions((yyvsp[0].expression)); }
+#line 1631 "cool.tab.c"
     break;
 
-  case 19:
-
-/* Line 1455 of yacc.c  */
-#line 214 "cool.y"
-    { (yyval.expressions) = append_Expressions((yyvsp[(1) - (3)].expressions), single_Expressions((yyvsp[(3) - (3)].expression))); }
+  case 19: /* expr_list_dispatch: expr_list_dispatch ',' expr  */
+#line 279 "cool.y"
+                                  { (yyval.expressions) = append_Expressions((yyvsp[-2].expressions), single_Expressions((yyvsp[0].expression))); }
+#line 1637 "cool.tab.c"
     break;
 
-  case 20:
-
-/* Line 1455 of yacc.c  */
-#line 218 "cool.y"
-    { (yyval.expressions) = single_Expressions((yyvsp[(1) - (2)].expression)); }
+  case 20: /* expr_list_block: expr ';'  */
+#line 283 "cool.y"
+             { (yyval.expressions) = single_Expressions((yyvsp[-1].expression)); }
+#line 1643 "cool.tab.c"
     break;
 
-  case 21:
-
-/* Line 1455 of yacc.c  */
-#line 219 "cool.y"
-    { (yyval.expressions) = append_Expressions((yyvsp[(1) - (3)].expressions), single_Expressions((yyvsp[(2) - (3)].expression))); }
+  case 21: /* expr_list_block: expr_list_block expr ';'  */
+#line 284 "cool.y"
+                               { (yyval.expressions) = append_Expressions((yyvsp[-2].expressions), single_Expressions((yyvsp[-1].expression))); }
+#line 1649 "cool.tab.c"
     break;
 
-  case 23:
-
-/* Line 1455 of yacc.c  */
-#line 223 "cool.y"
-    { (yyval.expression) = assign((yyvsp[(1) - (3)].symbol), (yyvsp[(3) - (3)].expression)); }
+  case 23: /* expr: OBJECTID ASSIGN expr  */
+#line 288 "cool.y"
+                         { (yyval.expression) = assign((yyvsp[-2].symbol), (yyvsp[0].expression)); }
+#line 1655 "cool.tab.c"
     break;
 
-  case 24:
-
-/* Line 1455 of yacc.c  */
-#line 225 "cool.y"
-    { (yyval.expression) = dispatch((yyvsp[(1) - (6)].expression), (yyvsp[(3) - (6)].symbol), (yyvsp[(5) - (6)].expressions)); }
+  case 24: /* expr: expr '.' OBJECTID '(' expr_list_dispatch ')'  */
+#line 290 "cool.y"
+        { (yyval.expression) = dispatch((yyvsp[-5].expression), (yyvsp[-3].symbol), (yyvsp[-1].expressions)); }
+#line 1661 "cool.tab.c"
     break;
 
-  case 25:
-
-/* Line 1455 of yacc.c  */
-#line 227 "cool.y"
-    { (yyval.expression) = dispatch((yyvsp[(1) - (5)].expression), (yyvsp[(3) - (5)].symbol), nil_Expressions()); }
+  case 25: /* expr: expr '.' OBJECTID '(' ')'  */
+#line 292 "cool.y"
+        { (yyval.expression) = dispatch((yyvsp[-4].expression), (yyvsp[-2].symbol), nil_Expressions()); }
+#line 1667 "cool.tab.c"
     break;
 
-  case 26:
-
-/* Line 1455 of yacc.c  */
-#line 229 "cool.y"
-    { (yyval.expression) = dispatch(object(idtable.add_string("self")), (yyvsp[(1) - (4)].symbol), (yyvsp[(3) - (4)].expressions)); }
+  case 26: /* expr: OBJECTID '(' expr_list_dispatch ')'  */
+#line 294 "cool.y"
+        { (yyval.expression) = dispatch(object(idtable.add_string("self")), (yyvsp[-3].symbol), (yyvsp[-1].expressions)); }
+#line 1673 "cool.tab.c"
     break;
 
-  case 27:
-
-/* Line 1455 of yacc.c  */
-#line 231 "cool.y"
-    { (yyval.expression) = dispatch(object(idtable.add_string("self")), (yyvsp[(1) - (3)].symbol), nil_Expressions()); }
+  case 27: /* expr: OBJECTID '(' ')'  */
+#line 296 "cool.y"
+        { (yyval.expression) = dispatch(object(idtable.add_string("self")), (yyvsp[-2].symbol), nil_Expressions()); }
+#line 1679 "cool.tab.c"
     break;
 
-  case 28:
-
-/* Line 1455 of yacc.c  */
-#line 233 "cool.y"
-    { (yyval.expression) = static_dispatch((yyvsp[(1) - (8)].expression), (yyvsp[(3) - (8)].symbol), (yyvsp[(5) - (8)].symbol), (yyvsp[(7) - (8)].expressions)); }
+  case 28: /* expr: expr '@' TYPEID '.' OBJECTID '(' expr_list_dispatch ')'  */
+#line 298 "cool.y"
+        { (yyval.expression) = static_dispatch((yyvsp[-7].expression), (yyvsp[-5].symbol), (yyvsp[-3].symbol), (yyvsp[-1].expressions)); }
+#line 1685 "cool.tab.c"
     break;
 
-  case 29:
-
-/* Line 1455 of yacc.c  */
-#line 235 "cool.y"
-    { (yyval.expression) = static_dispatch((yyvsp[(1) - (7)].expression), (yyvsp[(3) - (7)].symbol), (yyvsp[(5) - (7)].symbol), nil_Expressions()); }
+  case 29: /* expr: expr '@' TYPEID '.' OBJECTID '(' ')'  */
+#line 300 "cool.y"
+        { (yyval.expression) = static_dispatch((yyvsp[-6].expression), (yyvsp[-4].symbol), (yyvsp[-2].symbol), nil_Expressions()); }
+#line 1691 "cool.tab.c"
     break;
 
-  case 30:
-
-/* Line 1455 of yacc.c  */
-#line 236 "cool.y"
-    { (yyval.expression) = cond((yyvsp[(2) - (7)].expression), (yyvsp[(4) - (7)].expression), (yyvsp[(6) - (7)].expression)); }
+  case 30: /* expr: IF expr THEN expr ELSE expr FI  */
+#line 301 "cool.y"
+                                     { (yyval.expression) = cond((yyvsp[-5].expression), (yyvsp[-3].expression), (yyvsp[-1].expression)); }
+#line 1697 "cool.tab.c"
     break;
 
-  case 31:
-
-/* Line 1455 of yacc.c  */
-#line 237 "cool.y"
-    { (yyval.expression) = loop((yyvsp[(2) - (5)].expression), (yyvsp[(4) - (5)].expression)); }
+  case 31: /* expr: WHILE expr LOOP expr POOL  */
+#line 302 "cool.y"
+                                { (yyval.expression) = loop((yyvsp[-3].expression), (yyvsp[-1].expression)); }
+#line 1703 "cool.tab.c"
     break;
 
-  case 32:
-
-/* Line 1455 of yacc.c  */
-#line 238 "cool.y"
-    { (yyval.expression) = block((yyvsp[(2) - (3)].expressions)); }
+  case 32: /* expr: '{' expr_list_block '}'  */
+#line 303 "cool.y"
+                              { (yyval.expression) = block((yyvsp[-1].expressions)); }
+#line 1709 "cool.tab.c"
     break;
 
-  case 33:
-
-/* Line 1455 of yacc.c  */
-#line 239 "cool.y"
-    { (yyval.expression) = (yyvsp[(2) - (2)].expression); }
+  case 33: /* expr: LET let_list IN expr  */
+#line 304 "cool.y"
+                           { (yyval.expression) = build_let_chain((yyvsp[-2].boolean), (yyvsp[0].expression)); }
+#line 1715 "cool.tab.c"
     break;
 
-  case 34:
-
-/* Line 1455 of yacc.c  */
-#line 240 "cool.y"
-    { (yyval.expression) = typcase((yyvsp[(2) - (5)].expression), (yyvsp[(4) - (5)].cases)); }
+  case 34: /* expr: CASE expr OF case_list ESAC  */
+#line 305 "cool.y"
+                                  { (yyval.expression) = typcase((yyvsp[-3].expression), (yyvsp[-1].cases)); }
+#line 1721 "cool.tab.c"
     break;
 
-  case 35:
-
-/* Line 1455 of yacc.c  */
-#line 241 "cool.y"
-    { (yyval.expression) = new_((yyvsp[(2) - (2)].symbol)); }
+  case 35: /* expr: NEW TYPEID  */
+#line 306 "cool.y"
+                 { (yyval.expression) = new_((yyvsp[0].symbol)); }
+#line 1727 "cool.tab.c"
     break;
 
-  case 36:
-
-/* Line 1455 of yacc.c  */
-#line 242 "cool.y"
-    { (yyval.expression) = isvoid((yyvsp[(2) - (2)].expression)); }
+  case 36: /* expr: ISVOID expr  */
+#line 307 "cool.y"
+                  { (yyval.expression) = isvoid((yyvsp[0].expression)); }
+#line 1733 "cool.tab.c"
     break;
 
-  case 37:
-
-/* Line 1455 of yacc.c  */
-#line 243 "cool.y"
-    { (yyval.expression) = plus((yyvsp[(1) - (3)].expression), (yyvsp[(3) - (3)].expression)); }
+  case 37: /* expr: expr '+' expr  */
+#line 308 "cool.y"
+                    { (yyval.expression) = plus((yyvsp[-2].expression), (yyvsp[0].expression)); }
+#line 1739 "cool.tab.c"
     break;
 
-  case 38:
-
-/* Line 1455 of yacc.c  */
-#line 244 "cool.y"
-    { (yyval.expression) = sub((yyvsp[(1) - (3)].expression), (yyvsp[(3) - (3)].expression)); }
+  case 38: /* expr: expr '-' expr  */
+#line 309 "cool.y"
+                    { (yyval.expression) = sub((yyvsp[-2].expression), (yyvsp[0].expression)); }
+#line 1745 "cool.tab.c"
     break;
 
-  case 39:
-
-/* Line 1455 of yacc.c  */
-#line 245 "cool.y"
-    { (yyval.expression) = mul((yyvsp[(1) - (3)].expression), (yyvsp[(3) - (3)].expression)); }
+  case 39: /* expr: expr '*' expr  */
+#line 310 "cool.y"
+                    { (yyval.expression) = mul((yyvsp[-2].expression), (yyvsp[0].expression)); }
+#line 1751 "cool.tab.c"
     break;
 
-  case 40:
-
-/* Line 1455 of yacc.c  */
-#line 246 "cool.y"
-    { (yyval.expression) = divide((yyvsp[(1) - (3)].expression), (yyvsp[(3) - (3)].expression)); }
+  case 40: /* expr: expr '/' expr  */
+#line 311 "cool.y"
+                    { (yyval.expression) = divide((yyvsp[-2].expression), (yyvsp[0].expression)); }
+#line 1757 "cool.tab.c"
     break;
 
-  case 41:
-
-/* Line 1455 of yacc.c  */
-#line 247 "cool.y"
-    { (yyval.expression) = neg((yyvsp[(2) - (2)].expression)); }
+  case 41: /* expr: '~' expr  */
+#line 312 "cool.y"
+               { (yyval.expression) = neg((yyvsp[0].expression)); }
+#line 1763 "cool.tab.c"
     break;
 
-  case 42:
-
-/* Line 1455 of yacc.c  */
-#line 248 "cool.y"
-    { (yyval.expression) = lt((yyvsp[(1) - (3)].expression), (yyvsp[(3) - (3)].expression)); }
+  case 42: /* expr: expr '<' expr  */
+#line 313 "cool.y"
+                    { (yyval.expression) = lt((yyvsp[-2].expression), (yyvsp[0].expression)); }
+#line 1769 "cool.tab.c"
     break;
 
-  case 43:
-
-/* Line 1455 of yacc.c  */
-#line 249 "cool.y"
-    { (yyval.expression) = leq((yyvsp[(1) - (3)].expression), (yyvsp[(3) - (3)].expression)); }
+  case 43: /* expr: expr LE expr  */
+#line 314 "cool.y"
+                   { (yyval.expression) = leq((yyvsp[-2].expression), (yyvsp[0].expression)); }
+#line 1775 "cool.tab.c"
     break;
 
-  case 44:
-
-/* Line 1455 of yacc.c  */
-#line 250 "cool.y"
-    { (yyval.expression) = eq((yyvsp[(1) - (3)].expression), (yyvsp[(3) - (3)].expression)); }
+  case 44: /* expr: expr '=' expr  */
+#line 315 "cool.y"
+                    { (yyval.expression) = eq((yyvsp[-2].expression), (yyvsp[0].expression)); }
+#line 1781 "cool.tab.c"
     break;
 
-  case 45:
-
-/* Line 1455 of yacc.c  */
-#line 251 "cool.y"
-    { (yyval.expression) = comp((yyvsp[(2) - (2)].expression)); }
+  case 45: /* expr: NOT expr  */
+#line 316 "cool.y"
+               { (yyval.expression) = comp((yyvsp[0].expression)); }
+#line 1787 "cool.tab.c"
     break;
 
-  case 46:
-
-/* Line 1455 of yacc.c  */
-#line 252 "cool.y"
-    { (yyval.expression) = (yyvsp[(2) - (3)].expression);  }
+  case 46: /* expr: '(' expr ')'  */
+#line 317 "cool.y"
+                   { (yyval.expression) = (yyvsp[-1].expression);  }
+#line 1793 "cool.tab.c"
     break;
 
-  case 47:
-
-/* Line 1455 of yacc.c  */
-#line 253 "cool.y"
-    { (yyval.expression) = object((yyvsp[(1) - (1)].symbol)); }
+  case 47: /* expr: OBJECTID  */
+#line 318 "cool.y"
+               { (yyval.expression) = object((yyvsp[0].symbol)); }
+#line 1799 "cool.tab.c"
     break;
 
-  case 48:
-
-/* Line 1455 of yacc.c  */
-#line 254 "cool.y"
-    { (yyval.expression) = int_const((yyvsp[(1) - (1)].symbol)); }
+  case 48: /* expr: INT_CONST  */
+#line 319 "cool.y"
+                { (yyval.expression) = int_const((yyvsp[0].symbol)); }
+#line 1805 "cool.tab.c"
     break;
 
-  case 49:
-
-/* Line 1455 of yacc.c  */
-#line 255 "cool.y"
-    { (yyval.expression) = string_const((yyvsp[(1) - (1)].symbol)); }
+  case 49: /* expr: STR_CONST  */
+#line 320 "cool.y"
+                { (yyval.expression) = string_const((yyvsp[0].symbol)); }
+#line 1811 "cool.tab.c"
     break;
 
-  case 50:
-
-/* Line 1455 of yacc.c  */
-#line 256 "cool.y"
-    { (yyval.expression) = bool_const((yyvsp[(1) - (1)].boolean)); }
+  case 50: /* expr: BOOL_CONST  */
+#line 321 "cool.y"
+                 { (yyval.expression) = bool_const((yyvsp[0].boolean)); }
+#line 1817 "cool.tab.c"
     break;
 
-  case 51:
-
-/* Line 1455 of yacc.c  */
-#line 261 "cool.y"
-    { (yyval.expression) = let((yyvsp[(1) - (5)].symbol), (yyvsp[(3) - (5)].symbol), no_expr(), (yyvsp[(5) - (5)].expression)); }
+  case 51: /* let_list: let_binding  */
+#line 326 "cool.y"
+                { (yyval.boolean) = push_let_frame(); }
+#line 1823 "cool.tab.c"
     break;
 
-  case 52:
-
-/* Line 1455 of yacc.c  */
-#line 263 "cool.y"
-    { (yyval.expression) = let((yyvsp[(1) - (7)].symbol), (yyvsp[(3) - (7)].symbol), (yyvsp[(5) - (7)].expression), (yyvsp[(7) - (7)].expression)); }
+  case 52: /* let_list: let_errors let_binding  */
+#line 327 "cool.y"
+                             { (yyval.boolean) = push_let_frame(); }
+#line 1829 "cool.tab.c"
     break;
 
-  case 53:
-
-/* Line 1455 of yacc.c  */
-#line 265 "cool.y"
-    { (yyval.expression) = let((yyvsp[(1) - (5)].symbol), (yyvsp[(3) - (5)].symbol), no_expr(), (yyvsp[(5) - (5)].expression)); }
+  case 53: /* let_list: let_list ',' let_binding  */
+#line 328 "cool.y"
+                               { (yyval.boolean) = (yyvsp[-2].boolean); }
+#line 1835 "cool.tab.c"
     break;
 
-  case 54:
-
-/* Line 1455 of yacc.c  */
-#line 267 "cool.y"
-    { (yyval.expression) = let((yyvsp[(1) - (7)].symbol), (yyvsp[(3) - (7)].symbol), (yyvsp[(5) - (7)].expression), (yyvsp[(7) - (7)].expression)); }
+  case 54: /* let_list: let_list ',' let_errors let_binding  */
+#line 329 "cool.y"
+                                          { (yyval.boolean) = (yyvsp[-3].boolean); }
+#line 1841 "cool.tab.c"
     break;
 
-  case 55:
-
-/* Line 1455 of yacc.c  */
-#line 268 "cool.y"
-    { (yyval.expression) = (yyvsp[(3) - (3)].expression); }
+  case 55: /* let_binding: OBJECTID ':' TYPEID  */
+#line 333 "cool.y"
+        { push_let_binding((yyvsp[-2].symbol), (yyvsp[0].symbol), no_expr(), (yylsp[-2])); }
+#line 1847 "cool.tab.c"
     break;
 
-  case 56:
-
-/* Line 1455 of yacc.c  */
-#line 271 "cool.y"
-    { (yyval.cases) = nil_Cases(); }
+  case 56: /* let_binding: OBJECTID ':' TYPEID ASSIGN expr  */
+#line 335 "cool.y"
+        { push_let_binding((yyvsp[-4].symbol), (yyvsp[-2].symbol), (yyvsp[0].expression), (yylsp[-4])); }
+#line 1853 "cool.tab.c"
     break;
 
-  case 57:
-
-/* Line 1455 of yacc.c  */
-#line 272 "cool.y"
-    { (yyval.cases) = append_Cases((yyvsp[(1) - (2)].cases), single_Cases((yyvsp[(2) - (2)].case_))); }
+  case 59: /* case_list: %empty  */
+#line 342 "cool.y"
+                { (yyval.cases) = nil_Cases(); }
+#line 1859 "cool.tab.c"
     break;
 
-  case 58:
+  case 60: /* case_list: case_list case  */
+#line 343 "cool.y"
+                     { (yyval.cases) = append_Cases((yyvsp[-1].cases), single_Cases((yyvsp[0].case_))); }
+#line 1865 "cool.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 275 "cool.y"
-    { (yyval.case_) = branch((yyvsp[(1) - (6)].symbol), (yyvsp[(3) - (6)].symbol), (yyvsp[(5) - (6)].expression)); }
+  case 61: /* case: OBJECTID ':' TYPEID DARROW expr ';'  */
+#line 346 "cool.y"
+                                        { (yyval.case_) = branch((yyvsp[-5].symbol), (yyvsp[-3].symbol), (yyvsp[-1].expression)); }
+#line 1871 "cool.tab.c"
     break;
 
 
+#line 1875 "cool.tab.c"
 
-/* Line 1455 of yacc.c  */
-#line 2094 "cool.tab.c"
       default: break;
     }
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
   *++yylsp = yyloc;
 
-  /* Now `shift' the result of the reduction.  Determine what state
+  /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
 
-/*------------------------------------.
-| yyerrlab -- here on detecting error |
-`------------------------------------*/
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
 yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (YY_("syntax error"));
-#else
-      {
-	YYSIZE_T yysize = yysyntax_error (0, yystate, yychar);
-	if (yymsg_alloc < yysize && yymsg_alloc < YYSTACK_ALLOC_MAXIMUM)
-	  {
-	    YYSIZE_T yyalloc = 2 * yysize;
-	    if (! (yysize <= yyalloc && yyalloc <= YYSTACK_ALLOC_MAXIMUM))
-	      yyalloc = YYSTACK_ALLOC_MAXIMUM;
-	    if (yymsg != yymsgbuf)
-	      YYSTACK_FREE (yymsg);
-	    yymsg = (char *) YYSTACK_ALLOC (yyalloc);
-	    if (yymsg)
-	      yymsg_alloc = yyalloc;
-	    else
-	      {
-		yymsg = yymsgbuf;
-		yymsg_alloc = sizeof yymsgbuf;
-	      }
-	  }
-
-	if (0 < yysize && yysize <= yymsg_alloc)
-	  {
-	    (void) yysyntax_error (yymsg, yystate, yychar);
-	    yyerror (yymsg);
-	  }
-	else
-	  {
-	    yyerror (YY_("syntax error"));
-	    if (yysize != 0)
-	      goto yyexhaustedlab;
-	  }
-      }
-#endif
     }
 
-  yyerror_range[0] = yylloc;
-
+  yyerror_range[1] = yylloc;
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
-	 error, discard it.  */
+         error, discard it.  */
 
       if (yychar <= YYEOF)
-	{
-	  /* Return failure if at end of input.  */
-	  if (yychar == YYEOF)
-	    YYABORT;
-	}
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
       else
-	{
-	  yydestruct ("Error: discarding",
-		      yytoken, &yylval, &yylloc);
-	  yychar = YYEMPTY;
-	}
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, &yylloc);
+          yychar = YYEMPTY;
+        }
     }
 
   /* Else will try to reuse lookahead token after shifting the error
@@ -2192,15 +1951,13 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  yyerror_range[0] = yylsp[1-yylen];
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
   yylen = 0;
@@ -2213,44 +1970,45 @@ yyerrorlab:
 | yyerrlab1 -- common code for both syntax error and YYERROR.  |
 `-------------------------------------------------------------*/
 yyerrlab1:
-  yyerrstatus = 3;	/* Each real token shifted decrements this.  */
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
-      if (yyn != YYPACT_NINF)
-	{
-	  yyn += YYTERROR;
-	  if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
-	    {
-	      yyn = yytable[yyn];
-	      if (0 < yyn)
-		break;
-	    }
-	}
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
 
       /* Pop the current state because it cannot handle the error token.  */
       if (yyssp == yyss)
-	YYABORT;
+        YYABORT;
 
-      yyerror_range[0] = *yylsp;
+      yyerror_range[1] = *yylsp;
       yydestruct ("Error: popping",
-		  yystos[yystate], yyvsp, yylsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
     }
 
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
-  yyerror_range[1] = yylloc;
-  /* Using YYLLOC is tempting, but would change the location of
-     the lookahead.  YYLOC is available though.  */
-  YYLLOC_DEFAULT (yyloc, (yyerror_range - 1), 2);
-  *++yylsp = yyloc;
+  yyerror_range[2] = yylloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2261,55 +2019,57 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
-#if !defined(yyoverflow) || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
-     yydestruct ("Cleanup: discarding lookahead",
-		 yytoken, &yylval, &yylloc);
-  /* Do not reclaim the symbols of the rule which action triggered
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, &yylloc);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
   YYPOPSTACK (yylen);
   YY_STACK_PRINT (yyss, yyssp);
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-		  yystos[*yyssp], yyvsp, yylsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
-  /* Make sure YYID is used.  */
-  return YYID (yyresult);
-}
-
 
+  return yyresult;
+}
 
-/* Line 1675 of yacc.c  */
-#line 278 "cool.y"
+#line 349 "cool.y"
 
     
     /* This function is called automatically when Bison detects a parse error. */
@@ -2326,5 +2086,44 @@ yyreturn:
       if(omerrs>50) {fprintf(stdout, "More than 50 errors\n"); exit(1);}
     }
     
+    static void push_let_binding(Symbol identifier, Symbol type_decl,
+    Expression init, int lineno)
+    {
+      let_binding_t binding;
+      binding.identifier = identifier;
+      binding.type_decl = type_decl;
+      binding.init = init;
+      binding.lineno = lineno;
+      let_bindings.push_back(binding);
+    }
+    
+    /* Starts the frame of a let at its first binding. */
+    static Boolean push_let_frame()
+    {
+      let_frames.push_back(let_bindings.size() - 1);
+      return true;
+    }
+    
+    /* Pops the innermost let's bindings and wraps them around body, last
+    * binding innermost. Every let node gets the line of its own identifier,
+    * as it would have from the right-recursive rule. */
+    static Expression build_let_chain(Boolean let_list, Expression body)
+    {
+      size_t start = let_frames.back();
+      let_frames.pop_back();
+      for (size_t i = let_bindings.size(); i > start; i--) {
+        let_binding_t &binding = let_bindings[i - 1];
+        SET_NODELOC(binding.lineno);
+        body = let(binding.identifier, binding.type_decl, binding.init, body);
+      }
+      let_bindings.resize(start);
+      return body;
+    }
+    
+    static void discard_let_frame()
+    {
+      let_bindings.resize(let_frames.back());
+      let_frames.pop_back();
+    }
+    
     
-
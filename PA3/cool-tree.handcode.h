@@ -8,6 +8,7 @@
 #include "tree.h"
 #include "cool.h"
 #include "stringtab.h"
+#include "ast-binary.h"
 #define yylineno curr_lineno;
 extern int yylineno;
 
@@ -44,49 +45,83 @@ typedef Expressions_class *Expressions;
 typedef list_node<Case> Cases_class;
 typedef Cases_class *Cases;
 
+//
+// Walking the AST (see ast_walk in ast-binary.h). Each constructor lists
+// its fields without descending into them, and the walk keeps its own
+// stack, so that neither the binary AST output nor dump_with_types
+// (dumptype.cc) recurses once per level of nesting.
+//
+#define AST_FIELDS_EXTRAS                       \
+virtual ast_tag fields(ast_fields&) = 0;        \
+void dump_binary(ast_writer& w)                 \
+{ ast_record_writer r(w); ast_walk(this, r); }
+
 #define Program_EXTRAS                          \
-virtual void dump_with_types(ostream&, int) = 0; 
+virtual void dump_with_types(ostream&, int) = 0; \
+AST_FIELDS_EXTRAS
 
 
 
 #define program_EXTRAS                          \
-void dump_with_types(ostream&, int);            
+void dump_with_types(ostream&, int);            \
+ast_tag fields(ast_fields& f)                   \
+{ f.list(classes); return AST_PROGRAM; }
 
 #define Class__EXTRAS                   \
 virtual Symbol get_filename() = 0;      \
-virtual void dump_with_types(ostream&,int) = 0; 
+virtual void dump_with_types(ostream&,int) = 0; \
+AST_FIELDS_EXTRAS
 
 
 #define class__EXTRAS                                 \
 Symbol get_filename() { return filename; }             \
-void dump_with_types(ostream&,int);                    
+void dump_with_types(ostream&,int);                    \
+ast_tag fields(ast_fields& f)                          \
+{ f.symbol(name); f.symbol(parent); f.list(features);  \
+  f.symbol(filename, AST_STRING_TABLE); return AST_CLASS; }
 
 
 #define Feature_EXTRAS                                        \
-virtual void dump_with_types(ostream&,int) = 0; 
+virtual void dump_with_types(ostream&,int) = 0; \
+AST_FIELDS_EXTRAS
 
 
 #define Feature_SHARED_EXTRAS                                       \
 void dump_with_types(ostream&,int);    
 
+#define method_EXTRAS                                   \
+ast_tag fields(ast_fields& f)                           \
+{ f.symbol(name); f.list(formals); f.symbol(return_type); \
+  f.child(expr); return AST_METHOD; }
+
+#define attr_EXTRAS                                     \
+ast_tag fields(ast_fields& f)                           \
+{ f.symbol(name); f.symbol(type_decl); f.child(init); return AST_ATTR; }
+
 
 
 
 
 #define Formal_EXTRAS                              \
-virtual void dump_with_types(ostream&,int) = 0;
+virtual void dump_with_types(ostream&,int) = 0; \
+AST_FIELDS_EXTRAS
 
 
 #define formal_EXTRAS                           \
-void dump_with_types(ostream&,int);
+void dump_with_types(ostream&,int);             \
+ast_tag fields(ast_fields& f)                   \
+{ f.symbol(name); f.symbol(type_decl); return AST_FORMAL; }
 
 
 #define Case_EXTRAS                             \
-virtual void dump_with_types(ostream& ,int) = 0;
+virtual void dump_with_types(ostream& ,int) = 0; \
+AST_FIELDS_EXTRAS
 
 
 #define branch_EXTRAS                                   \
-void dump_with_types(ostream& ,int);
+void dump_with_types(ostream& ,int);                    \
+ast_tag fields(ast_fields& f)                           \
+{ f.symbol(name); f.symbol(type_decl); f.child(expr); return AST_BRANCH; }
 
 
 #define Expression_EXTRAS                    \
@@ -95,6 +130,7 @@ Symbol get_type() { return type; }           \
 Expression set_type(Symbol s) { type = s; return this; } \
 virtual void dump_with_types(ostream&,int) = 0;  \
 void dump_type(ostream&, int);               \
+AST_FIELDS_EXTRAS                            \
 Expression_class() { type = (Symbol) NULL; }
 
 
@@ -103,4 +139,63 @@ Expression_class() { type = (Symbol) NULL; }
 void dump_with_types(ostream&,int); 
 
 
+//
+// Expression fields; the type is listed last by EXPR_FIELDS.
+//
+#define EXPR_FIELDS(tag, list)               \
+ast_tag fields(ast_fields& f)                \
+{ list; f.type(type); return tag; }
+
+#define assign_EXTRAS \
+EXPR_FIELDS(AST_ASSIGN, f.symbol(name); f.child(expr))
+#define static_dispatch_EXTRAS \
+EXPR_FIELDS(AST_STATIC_DISPATCH, f.child(expr); f.symbol(type_name); \
+            f.symbol(name); f.list(actual))
+#define dispatch_EXTRAS \
+EXPR_FIELDS(AST_DISPATCH, f.child(expr); f.symbol(name); f.list(actual))
+#define cond_EXTRAS \
+EXPR_FIELDS(AST_COND, f.child(pred); f.child(then_exp); f.child(else_exp))
+#define loop_EXTRAS \
+EXPR_FIELDS(AST_LOOP, f.child(pred); f.child(body))
+#define typcase_EXTRAS \
+EXPR_FIELDS(AST_TYPCASE, f.child(expr); f.list(cases))
+#define block_EXTRAS \
+EXPR_FIELDS(AST_BLOCK, f.list(body))
+#define let_EXTRAS \
+EXPR_FIELDS(AST_LET, f.symbol(identifier); f.symbol(type_decl); \
+            f.child(init); f.child(body))
+#define plus_EXTRAS \
+EXPR_FIELDS(AST_PLUS, f.child(e1); f.child(e2))
+#define sub_EXTRAS \
+EXPR_FIELDS(AST_SUB, f.child(e1); f.child(e2))
+#define mul_EXTRAS \
+EXPR_FIELDS(AST_MUL, f.child(e1); f.child(e2))
+#define divide_EXTRAS \
+EXPR_FIELDS(AST_DIVIDE, f.child(e1); f.child(e2))
+#define neg_EXTRAS \
+EXPR_FIELDS(AST_NEG, f.child(e1))
+#define lt_EXTRAS \
+EXPR_FIELDS(AST_LT, f.child(e1); f.child(e2))
+#define eq_EXTRAS \
+EXPR_FIELDS(AST_EQ, f.child(e1); f.child(e2))
+#define leq_EXTRAS \
+EXPR_FIELDS(AST_LEQ, f.child(e1); f.child(e2))
+#define comp_EXTRAS \
+EXPR_FIELDS(AST_COMP, f.child(e1))
+#define int_const_EXTRAS \
+EXPR_FIELDS(AST_INT_CONST, f.symbol(token, AST_INT_TABLE))
+#define bool_const_EXTRAS \
+EXPR_FIELDS(AST_BOOL_CONST, f.boolean(val))
+#define string_const_EXTRAS \
+EXPR_FIELDS(AST_STRING_CONST, f.symbol(token, AST_STRING_TABLE))
+#define new__EXTRAS \
+EXPR_FIELDS(AST_NEW, f.symbol(type_name))
+#define isvoid_EXTRAS \
+EXPR_FIELDS(AST_ISVOID, f.child(e1))
+#define no_expr_EXTRAS \
+EXPR_FIELDS(AST_NO_EXPR, )
+#define object_EXTRAS \
+EXPR_FIELDS(AST_OBJECT, f.symbol(name))
+
+
 #endif
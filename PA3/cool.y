@@ -5,6 +5,8 @@
 */
 %{
   #include <iostream>
+  #include <vector>
+  #include <algorithm>
   #include "cool-tree.h"
   #include "stringtab.h"
   #include "utilities.h"
@@ -14,6 +16,9 @@
   
   /* Locations */
   #define YYLTYPE int              /* the type of locations */
+  #define YYMAXDEPTH 10000         /* the stacks start at bison's default
+  depth and grow up to this (see grow_parser_stacks) */
+  #define yyoverflow grow_parser_stacks
   #define cool_yylloc curr_lineno  /* use the curr_lineno from the lexer
   for the location of tokens */
     
@@ -77,6 +82,61 @@
     void yyerror(char *s);        /*  defined below; called for each parse error */
     extern int yylex();           /*  the entry point to the lexer  */
     
+    /* Bison only grows its stacks itself in C++ if YYLTYPE is a struct,
+    which ours is not, so yyoverflow does it instead. Each stack doubles,
+    up to YYMAXDEPTH, into storage that is kept for the next parse. If the
+    stacks are full the size is left alone and the parse is aborted. */
+    template <int Stack, class T>
+    static void grow_parser_stack(T **stack, size_t used_bytes, size_t depth)
+    {
+      static std::vector<T> storage;
+      std::vector<T> grown(depth);
+      std::copy(*stack, *stack + used_bytes / sizeof(T), grown.begin());
+      storage.swap(grown);
+      *stack = &storage[0];
+    }
+    
+    template <class State, class Value, class Location, class Size>
+    static void grow_parser_stacks(const char *message,
+    State **states, size_t states_bytes,
+    Value **values, size_t values_bytes,
+    Location **locations, size_t locations_bytes,
+    Size *depth)
+    {
+      if (*depth >= YYMAXDEPTH) {
+        yyerror((char *) message);
+        return;
+      }
+      *depth = std::min<Size>(*depth * 2, YYMAXDEPTH);
+      grow_parser_stack<0>(states, states_bytes, *depth);
+      grow_parser_stack<1>(values, values_bytes, *depth);
+      grow_parser_stack<2>(locations, locations_bytes, *depth);
+    }
+    
+    /* Let bindings are collected left to right on an explicit stack instead
+    * of through a right-recursive rule, so a let with thousands of bindings
+    * doesn't grow the bison stack. Each let records where its bindings start
+    * (let_frames); nested lets inside initializers push and pop their own
+    * frames before the enclosing binding is pushed. Once the body is parsed
+    * the usual chain of nested let nodes is built from the inside out. A
+    * let_list thrown away by error recovery drops its frame (see the
+    * %destructor below), so the frames always match the open lets.
+    */
+    struct let_binding_t {
+      Symbol identifier;
+      Symbol type_decl;
+      Expression init;
+      int lineno;
+    };
+    static std::vector<let_binding_t> let_bindings;
+    static std::vector<size_t> let_frames;
+    
+    static void push_let_binding(Symbol identifier, Symbol type_decl,
+    Expression init, int lineno);
+    static Boolean push_let_frame();
+    static Expression build_let_chain(Boolean let_list, Expression body);
+    static void discard_let_frame();
+    
     /************************************************************************/
     /*                DONT CHANGE ANYTHING IN THIS SECTION                  */
     
@@ -142,10 +202,15 @@
     %type <expressions> expr_list_dispatch /* Comma-separated list */
     %type <expressions> expr_list_block    /* Semicolon-separated list */
     %type <expression> expr
-    %type <expression> expr_let
     %type <cases> case_list
     %type <case_> case
 
+    /* A let_list owns its let's frame; its value is always true. One
+    popped by error recovery, or left on the stack when the parse is
+    aborted, takes its bindings with it. */
+    %type <boolean> let_list
+    %destructor { discard_let_frame(); } let_list
+
     /* Precedence declarations go here. */
 
     %left ASSIGN
@@ -236,7 +301,7 @@
     | IF expr THEN expr ELSE expr FI { $$ = cond($2, $4, $6); }
     | WHILE expr LOOP expr POOL { $$ = loop($2, $4); }
     | '{' expr_list_block '}' { $$ = block($2); }
-    | LET expr_let { $$ = $2; }
+    | LET let_list IN expr { $$ = build_let_chain($2, $4); }
     | CASE expr OF case_list ESAC { $$ = typcase($2, $4); }
     | NEW TYPEID { $$ = new_($2); }
     | ISVOID expr { $$ = isvoid($2); }
@@ -255,17 +320,23 @@
     | STR_CONST { $$ = string_const($1); }
     | BOOL_CONST { $$ = bool_const($1); }
 
-    /* Nested let expressions (right-associative) */
-    expr_let:
-    OBJECTID ':' TYPEID IN expr
-        { $$ = let($1, $3, no_expr(), $5); }
-    | OBJECTID ':' TYPEID ASSIGN expr IN expr
-        { $$ = let($1, $3, $5, $7); }
-    | OBJECTID ':' TYPEID ',' expr_let
-        { $$ = let($1, $3, no_expr(), $5); }
-    | OBJECTID ':' TYPEID ASSIGN expr ',' expr_let
-        { $$ = let($1, $3, $5, $7); }
-    | error ',' expr_let { $$ = $3; }
+    /* Let bindings (left-recursive, see build_let_chain). A binding with
+       a syntax error is skipped up to the next comma. */
+    let_list:
+    let_binding { $$ = push_let_frame(); }
+    | let_errors let_binding { $$ = push_let_frame(); }
+    | let_list ',' let_binding { $$ = $1; }
+    | let_list ',' let_errors let_binding { $$ = $1; }
+
+    let_binding:
+    OBJECTID ':' TYPEID
+        { push_let_binding($1, $3, no_expr(), @1); }
+    | OBJECTID ':' TYPEID ASSIGN expr
+        { push_let_binding($1, $3, $5, @1); }
+
+    let_errors:
+    error ','
+    | let_errors error ','
 
     case_list:
     /* empty */ { $$ = nil_Cases(); }
@@ -291,4 +362,44 @@
       if(omerrs>50) {fprintf(stdout, "More than 50 errors\n"); exit(1);}
     }
     
+    static void push_let_binding(Symbol identifier, Symbol type_decl,
+    Expression init, int lineno)
+    {
+      let_binding_t binding;
+      binding.identifier = identifier;
+      binding.type_decl = type_decl;
+      binding.init = init;
+      binding.lineno = lineno;
+      let_bindings.push_back(binding);
+    }
+    
+    /* Starts the frame of a let at its first binding. */
+    static Boolean push_let_frame()
+    {
+      let_frames.push_back(let_bindings.size() - 1);
+      return true;
+    }
+    
+    /* Pops the innermost let's bindings and wraps them around body, last
+    * binding innermost. Every let node gets the line of its own identifier,
+    * as it would have from the right-recursive rule. */
+    static Expression build_let_chain(Boolean let_list, Expression body)
+    {
+      size_t start = let_frames.back();
+      let_frames.pop_back();
+      for (size_t i = let_bindings.size(); i > start; i--) {
+        let_binding_t &binding = let_bindings[i - 1];
+        SET_NODELOC(binding.lineno);
+        body = let(binding.identifier, binding.type_decl, binding.init, body);
+      }
+      let_bindings.resize(start);
+      return body;
+    }
+    
+    static void discard_let_frame()
+    {
+      let_bindings.resize(let_frames.back());
+      let_frames.pop_back();
+    }
+    
     
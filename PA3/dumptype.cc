@@ -1 +0,0 @@
-/usr/class/cs143/cool/src/PA3/dumptype.cc
\ No newline at end of file
@@ -0,0 +1,10 @@
+//
+// dumptype.cc
+//
+// The parser writes the AST as the same dump_with_types text as the
+// semantic analyzer, so it has one definition, in PA4/dumptype.cc. This
+// assignment's cool-tree.h comes first, so that the one included there is
+// skipped.
+//
+#include "cool-tree.h"
+#include "../PA4/dumptype.cc"
@@ -0,0 +1,165 @@
+#!/usr/bin/perl -w
+#
+# parser-bench.pl
+#
+# Parse-only throughput and memory benchmark for the COOL parser.
+#
+# Usage:
+#   parser-bench.pl [options]
+#
+# Runs the lexer once over every grading/*.test file plus a set of
+# generated programs (deep expression nesting, long let chains and wide
+# case lists), then feeds each token stream to parser-bench, which times
+# only the cool_yyparse call (see parser-bench.cc). Reports nodes/sec,
+# tokens/sec and heap bytes allocated during the parse for every input,
+# followed by totals.
+#
+
+use strict;
+
+use File::Temp qw(tempdir);
+use Getopt::Long;
+
+my $lexer = "./lexer";
+my $bench = "./parser-bench";
+my $grading_dir = "./grading";
+my $reps = 3;
+my $size = 500;
+my $keep;
+
+sub usage {
+    print "Usage: $0 [options]\n";
+    print "    Options: -lexer <path>  - lexer to produce token streams [default = \"$lexer\"]\n";
+    print "             -bench <path>  - parse-only driver [default = \"$bench\"]\n";
+    print "             -dir <path>    - directory of *.test inputs [default = \"$grading_dir\"]\n";
+    print "             -reps <n>      - runs per input; the fastest is reported [default = $reps]\n";
+    print "             -size <n>      - size of the generated programs [default = $size]\n";
+    print "             -keep          - keep generated programs and token streams\n";
+    return "\n";
+}
+
+die usage()
+    unless(GetOptions("lexer=s" => \$lexer,
+		      "bench=s" => \$bench,
+		      "dir=s" => \$grading_dir,
+		      "reps=i" => \$reps,
+		      "size=i" => \$size,
+		      "keep" => \$keep));
+
+die "$bench not found; see parser-bench.cc for how to build it\n" unless -x $bench;
+
+my $work_dir = tempdir("parser-bench-XXXXXX", TMPDIR => 1, CLEANUP => !$keep);
+
+#
+# Generated programs. Each one stresses a different shape of parse tree.
+#
+
+# ((((1 + 1) + 1) ... ) + 1): the bison stack grows with the nesting depth.
+sub gen_deep_nesting {
+    my ($n) = @_;
+    return "class Main {\n  main() : Int {\n    " .
+	("(" x $n) . "1" . (" + 1)" x $n) . "\n  };\n};\n";
+}
+
+# 1 + 2 * 3 - 4 ...: a long left-associative operator chain.
+sub gen_operator_chain {
+    my ($n) = @_;
+    my @ops = ("+", "-", "*", "/");
+    my $expr = "x";
+    for (my $i = 1; $i <= $n; $i++) {
+	$expr .= " " . $ops[$i % 4] . " " . $i;
+	$expr .= "\n     " if $i % 10 == 0;
+    }
+    return "class Main {\n  x : Int <- 1;\n  main() : Int {\n    $expr\n  };\n};\n";
+}
+
+# let x1 : Int <- 0, x2 : Int <- x1, ... in xn: one right-recursive expr_let.
+sub gen_let_chain {
+    my ($n) = @_;
+    my @bindings = ("x1 : Int <- 0");
+    for (my $i = 2; $i <= $n; $i++) {
+	push @bindings, "x$i : Int <- x" . ($i - 1) . " + 1";
+    }
+    return "class Main {\n  main() : Int {\n    let " .
+	join(",\n        ", @bindings) . "\n    in x$n\n  };\n};\n";
+}
+
+# case o of b1 : C1 => 1; ... esac with one class per branch.
+sub gen_wide_case {
+    my ($n) = @_;
+    my $prog = "";
+    my $branches = "";
+    for (my $i = 1; $i <= $n; $i++) {
+	$prog .= "class C$i {\n};\n";
+	$branches .= "      b$i : C$i => $i;\n";
+    }
+    return $prog . "class Main {\n  o : Object;\n  main() : Int {\n" .
+	"    case o of\n$branches    esac\n  };\n};\n";
+}
+
+my %generators = (
+    "deep_nesting" => \&gen_deep_nesting,
+    "operator_chain" => \&gen_operator_chain,
+    "let_chain" => \&gen_let_chain,
+    "wide_case" => \&gen_wide_case,
+);
+
+my @inputs = sort glob("$grading_dir/*.test");
+foreach my $name (sort keys %generators) {
+    my $file = "$work_dir/$name.cl";
+    open(OUT, ">$file") || die "Cannot write $file: $!\n";
+    print OUT $generators{$name}->($size);
+    close(OUT);
+    push @inputs, $file;
+}
+
+#
+# Lex once, then parse each token stream $reps times keeping the fastest run.
+#
+my ($total_tokens, $total_nodes, $total_bytes, $total_usec) = (0, 0, 0, 0);
+my $skipped = 0;
+
+printf("%-32s %8s %8s %10s %12s %12s %10s\n",
+       "input", "tokens", "nodes", "usec", "nodes/sec", "tokens/sec", "bytes");
+
+foreach my $input (@inputs) {
+    my $name = $input;
+    $name =~ s/.*\///;
+    my $tokens_file = "$work_dir/$name.tok";
+    system("$lexer $input > $tokens_file") == 0 || die "$lexer $input failed\n";
+
+    my $tokens = 0;
+    open(TOK, $tokens_file) || die "Cannot read $tokens_file: $!\n";
+    while (<TOK>) {
+	$tokens++ if /^#\d+ /;
+    }
+    close(TOK);
+
+    my ($usec, $nodes, $bytes);
+    for (my $i = 0; $i < $reps; $i++) {
+	my $result = `$bench < $tokens_file 2>/dev/null`;
+	last unless $? == 0 && $result =~ /parse_usec=(\d+) nodes=(\d+) alloc_bytes=(\d+)/;
+	$usec = $1 if !defined($usec) || $1 < $usec;
+	($nodes, $bytes) = ($2, $3);
+    }
+    if (!defined($usec)) {
+	# Inputs with syntax errors are part of the grading set; skip them.
+	$skipped++;
+	next;
+    }
+
+    my $secs = ($usec > 0 ? $usec : 1) / 1e6;
+    printf("%-32s %8d %8d %10d %12.0f %12.0f %10d\n",
+	   $name, $tokens, $nodes, $usec, $nodes / $secs, $tokens / $secs, $bytes);
+    $total_tokens += $tokens;
+    $total_nodes += $nodes;
+    $total_bytes += $bytes;
+    $total_usec += $usec;
+}
+
+my $total_secs = ($total_usec > 0 ? $total_usec : 1) / 1e6;
+printf("%-32s %8d %8d %10d %12.0f %12.0f %10d\n",
+       "TOTAL", $total_tokens, $total_nodes, $total_usec,
+       $total_nodes / $total_secs, $total_tokens / $total_secs, $total_bytes);
+print "($skipped inputs with parse errors skipped)\n" if $skipped;
+print "Generated programs kept in $work_dir\n" if $keep;
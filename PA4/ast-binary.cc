@@ -0,0 +1,413 @@
+//
+// ast-binary.cc
+//
+// Reader for the binary AST encoding described in ast-binary.h. Nodes are
+// built with the usual cool-tree constructors, with node_lineno set to the
+// recorded line first so that every node keeps its original line number.
+//
+
+#include <string.h>
+#include "cool-tree.h"
+#include "utilities.h"
+
+extern int node_lineno;
+
+const char *ast_schema(unsigned tag)
+{
+    switch (tag) {
+    case AST_PROGRAM:         return "L";
+    case AST_CLASS:           return "SSLS";
+    case AST_METHOD:          return "SLSN";
+    case AST_ATTR:            return "SSN";
+    case AST_FORMAL:          return "SS";
+    case AST_BRANCH:          return "SSN";
+    case AST_ASSIGN:          return "SN";
+    case AST_STATIC_DISPATCH: return "NSSL";
+    case AST_DISPATCH:        return "NSL";
+    case AST_COND:            return "NNN";
+    case AST_LOOP:            return "NN";
+    case AST_TYPCASE:         return "NL";
+    case AST_BLOCK:           return "L";
+    case AST_LET:             return "SSNN";
+    case AST_PLUS:
+    case AST_SUB:
+    case AST_MUL:
+    case AST_DIVIDE:
+    case AST_LT:
+    case AST_EQ:
+    case AST_LEQ:             return "NN";
+    case AST_NEG:
+    case AST_COMP:
+    case AST_ISVOID:          return "N";
+    case AST_INT_CONST:
+    case AST_STRING_CONST:
+    case AST_NEW:
+    case AST_OBJECT:          return "S";
+    case AST_BOOL_CONST:      return "B";
+    case AST_NO_EXPR:         return "";
+    default:                  return NULL;
+    }
+}
+
+bool ast_tag_has_kind(unsigned tag, ast_kind kind)
+{
+    switch (kind) {
+    case AST_KIND_PROGRAM: return tag == AST_PROGRAM;
+    case AST_KIND_CLASS:   return tag == AST_CLASS;
+    case AST_KIND_FEATURE: return tag == AST_METHOD || tag == AST_ATTR;
+    case AST_KIND_FORMAL:  return tag == AST_FORMAL;
+    case AST_KIND_CASE:    return tag == AST_BRANCH;
+    default:               return tag >= AST_ASSIGN && ast_schema(tag) != NULL;
+    }
+}
+
+ast_kind ast_child_kind(unsigned tag, char field)
+{
+    switch (tag) {
+    case AST_PROGRAM: return AST_KIND_CLASS;
+    case AST_CLASS:   return AST_KIND_FEATURE;
+    case AST_METHOD:  return field == 'L' ? AST_KIND_FORMAL : AST_KIND_EXPRESSION;
+    case AST_TYPCASE: return field == 'L' ? AST_KIND_CASE : AST_KIND_EXPRESSION;
+    default:          return AST_KIND_EXPRESSION;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// Building nodes
+//
+/////////////////////////////////////////////////////////////////////
+
+template <class Elem>
+static list_node<Elem> *build_list(std::vector<Elem>& elems, size_t lo, size_t hi)
+{
+    if (hi - lo == 0)
+        return list_node<Elem>::nil();
+    if (hi - lo == 1)
+        return list_node<Elem>::single(elems[lo]);
+    size_t mid = lo + (hi - lo) / 2;
+    return list_node<Elem>::append(build_list(elems, lo, mid), build_list(elems, mid, hi));
+}
+
+template <class Elem>
+static tree_node *build_list(std::vector<Elem>& elems)
+{
+    return build_list(elems, 0, elems.size());
+}
+
+void ast_builder::list(unsigned tag, size_t start)
+{
+    size_t n = values.size() - start;
+    tree_node *result;
+    switch (ast_child_kind(tag, 'L')) {
+    case AST_KIND_CLASS: {
+        std::vector<Class_> elems(n);
+        for (size_t i = 0; i < n; i++)
+            elems[i] = static_cast<Class_>(values[start + i].node);
+        result = build_list(elems);
+        break;
+    }
+    case AST_KIND_FEATURE: {
+        std::vector<Feature> elems(n);
+        for (size_t i = 0; i < n; i++)
+            elems[i] = static_cast<Feature>(values[start + i].node);
+        result = build_list(elems);
+        break;
+    }
+    case AST_KIND_FORMAL: {
+        std::vector<Formal> elems(n);
+        for (size_t i = 0; i < n; i++)
+            elems[i] = static_cast<Formal>(values[start + i].node);
+        result = build_list(elems);
+        break;
+    }
+    case AST_KIND_CASE: {
+        std::vector<Case> elems(n);
+        for (size_t i = 0; i < n; i++)
+            elems[i] = static_cast<Case>(values[start + i].node);
+        result = build_list(elems);
+        break;
+    }
+    default: {
+        std::vector<Expression> elems(n);
+        for (size_t i = 0; i < n; i++)
+            elems[i] = static_cast<Expression>(values[start + i].node);
+        result = build_list(elems);
+        break;
+    }
+    }
+    values.resize(start);
+    node(result);
+}
+
+/*
+ * The fields are all built by now, so node_lineno, which constructing them
+ * resets, can be set just before the node itself is constructed.
+ */
+tree_node *ast_builder::build(unsigned tag, int line, size_t start, Symbol type)
+{
+    std::vector<value>::iterator v = values.begin() + start;
+#define NODE(i, T) static_cast<T>(v[i].node)
+    tree_node *result;
+    Expression e = NULL;
+    node_lineno = line;
+
+    switch (tag) {
+    case AST_PROGRAM:
+        result = program(NODE(0, Classes));
+        break;
+    case AST_CLASS:
+        result = class_(v[0].symbol, v[1].symbol, NODE(2, Features), v[3].symbol);
+        break;
+    case AST_METHOD:
+        result = method(v[0].symbol, NODE(1, Formals), v[2].symbol, NODE(3, Expression));
+        break;
+    case AST_ATTR:
+        result = attr(v[0].symbol, v[1].symbol, NODE(2, Expression));
+        break;
+    case AST_FORMAL:
+        result = formal(v[0].symbol, v[1].symbol);
+        break;
+    case AST_BRANCH:
+        result = branch(v[0].symbol, v[1].symbol, NODE(2, Expression));
+        break;
+    case AST_ASSIGN:
+        e = assign(v[0].symbol, NODE(1, Expression));
+        break;
+    case AST_STATIC_DISPATCH:
+        e = static_dispatch(NODE(0, Expression), v[1].symbol, v[2].symbol, NODE(3, Expressions));
+        break;
+    case AST_DISPATCH:
+        e = dispatch(NODE(0, Expression), v[1].symbol, NODE(2, Expressions));
+        break;
+    case AST_COND:
+        e = cond(NODE(0, Expression), NODE(1, Expression), NODE(2, Expression));
+        break;
+    case AST_LOOP:
+        e = loop(NODE(0, Expression), NODE(1, Expression));
+        break;
+    case AST_TYPCASE:
+        e = typcase(NODE(0, Expression), NODE(1, Cases));
+        break;
+    case AST_BLOCK:
+        e = block(NODE(0, Expressions));
+        break;
+    case AST_LET:
+        e = let(v[0].symbol, v[1].symbol, NODE(2, Expression), NODE(3, Expression));
+        break;
+    case AST_PLUS:   e = plus(NODE(0, Expression), NODE(1, Expression)); break;
+    case AST_SUB:    e = sub(NODE(0, Expression), NODE(1, Expression)); break;
+    case AST_MUL:    e = mul(NODE(0, Expression), NODE(1, Expression)); break;
+    case AST_DIVIDE: e = divide(NODE(0, Expression), NODE(1, Expression)); break;
+    case AST_LT:     e = lt(NODE(0, Expression), NODE(1, Expression)); break;
+    case AST_EQ:     e = eq(NODE(0, Expression), NODE(1, Expression)); break;
+    case AST_LEQ:    e = leq(NODE(0, Expression), NODE(1, Expression)); break;
+    case AST_NEG:    e = neg(NODE(0, Expression)); break;
+    case AST_COMP:   e = comp(NODE(0, Expression)); break;
+    case AST_ISVOID: e = isvoid(NODE(0, Expression)); break;
+    case AST_INT_CONST:    e = int_const(v[0].symbol); break;
+    case AST_BOOL_CONST:   e = bool_const(v[0].boolean); break;
+    case AST_STRING_CONST: e = string_const(v[0].symbol); break;
+    case AST_NEW:          e = new_(v[0].symbol); break;
+    case AST_OBJECT:       e = object(v[0].symbol); break;
+    default:               e = no_expr(); break;
+    }
+#undef NODE
+
+    if (e != NULL)
+        result = e->set_type(type);
+    values.resize(start);
+    return result;
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// Reader
+//
+/////////////////////////////////////////////////////////////////////
+
+ast_reader::ast_reader(const char *data, size_t size)
+{
+    pos = (const unsigned char *) data;
+    end = pos + size;
+    failure = NULL;
+}
+
+/* Records the first error; every read after it returns 0. */
+void ast_reader::fail(const char *message)
+{
+    if (failure == NULL)
+        failure = message;
+    pos = end;
+}
+
+unsigned ast_reader::varint()
+{
+    unsigned value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos == end) {
+            fail("binary AST: unexpected end of input");
+            return 0;
+        }
+        unsigned char b = *pos++;
+        value |= (unsigned) (b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+            return value;
+    }
+    fail("binary AST: malformed integer");
+    return 0;
+}
+
+Symbol ast_reader::symbol()
+{
+    unsigned index = varint();
+    if (index >= symbols.size()) {
+        fail("binary AST: symbol index out of range");
+        return NULL;
+    }
+    return symbols[index];
+}
+
+/* An expression type is 0 (not yet typed) or a symbol index + 1. */
+Symbol ast_reader::type()
+{
+    unsigned index = varint();
+    if (index == 0)
+        return NULL;
+    if (index > symbols.size()) {
+        fail("binary AST: symbol index out of range");
+        return NULL;
+    }
+    return symbols[index - 1];
+}
+
+/*
+ * Reads the header and the symbol section, interning every symbol into the
+ * table it came from.
+ */
+void ast_reader::read_symbols()
+{
+    size_t magic_len = strlen(AST_BINARY_MAGIC);
+    if ((size_t) (end - pos) < magic_len + 1 ||
+        memcmp(pos, AST_BINARY_MAGIC, magic_len) != 0) {
+        fail("binary AST: bad magic number");
+        return;
+    }
+    pos += magic_len;
+    if (*pos++ != AST_BINARY_VERSION) {
+        fail("binary AST: unsupported format version");
+        return;
+    }
+
+    unsigned count = varint();
+    if ((size_t) (end - pos) < count)       // every symbol takes 2 bytes or more
+        fail("binary AST: unexpected end of input");
+    symbols.reserve(failure == NULL ? count : 0);
+    std::string text;
+    for (unsigned i = 0; i < count && failure == NULL; i++) {
+        unsigned table = varint();
+        unsigned len = varint();
+        if ((size_t) (end - pos) < len) {
+            fail("binary AST: unexpected end of input");
+            return;
+        }
+        text.assign((const char *) pos, len);
+        pos += len;
+
+        char *str = const_cast<char *>(text.c_str());
+        switch (table) {
+        case AST_ID_TABLE:     symbols.push_back(idtable.add_string(str, len)); break;
+        case AST_INT_TABLE:    symbols.push_back(inttable.add_string(str, len)); break;
+        case AST_STRING_TABLE: symbols.push_back(stringtable.add_string(str, len)); break;
+        default:               fail("binary AST: unknown symbol table"); break;
+        }
+    }
+}
+
+/* Reads a record's tag and line and starts on its fields. */
+void ast_reader::open(ast_kind kind)
+{
+    frame f;
+    f.tag = varint();
+    f.line = varint();
+    f.field = ast_schema(f.tag);
+    if (f.field == NULL || !ast_tag_has_kind(f.tag, kind)) {
+        fail("binary AST: unexpected node tag");
+        return;
+    }
+    f.start = builder.mark();
+    f.in_list = false;
+    f.list_left = 0;
+    stack.push_back(f);
+}
+
+/*
+ * Reads the record of a node of the given kind and its subtree, returning
+ * the node, or NULL on an error. The records of the nodes being read are
+ * kept on stack; the top one reads its next field, or its list's next
+ * element, which pushes the record of a child. A record whose fields have
+ * all been read is built, popped, and becomes a field of the one below.
+ */
+tree_node *ast_reader::read_tree(ast_kind kind)
+{
+    stack.clear();
+    builder.clear();
+    open(kind);
+    while (failure == NULL) {
+        frame& f = stack.back();
+        if (f.list_left > 0) {
+            f.list_left--;
+            open(ast_child_kind(f.tag, 'L'));
+            continue;
+        }
+        if (f.in_list) {
+            builder.list(f.tag, f.list);
+            f.in_list = false;
+            continue;
+        }
+
+        char field = *f.field;
+        if (field == '\0') {
+            Symbol t = f.tag >= AST_ASSIGN ? type() : NULL;
+            tree_node *node = builder.build(f.tag, f.line, f.start, t);
+            stack.pop_back();
+            if (stack.empty())
+                return failure == NULL ? node : NULL;
+            builder.node(node);
+            continue;
+        }
+        f.field++;
+        switch (field) {
+        case 'S':
+            builder.symbol(symbol());
+            break;
+        case 'B': {
+            unsigned b = varint();
+            if (b > 1)
+                fail("binary AST: malformed boolean");
+            builder.boolean(b != 0);
+            break;
+        }
+        case 'N':
+            open(ast_child_kind(f.tag, 'N'));
+            break;
+        case 'L':
+            f.list_left = varint();
+            if ((size_t) (end - pos) < f.list_left)  // every element is > 1 byte
+                fail("binary AST: unexpected end of input");
+            f.in_list = true;
+            f.list = builder.mark();
+            break;
+        }
+    }
+    return NULL;
+}
+
+Program ast_reader::read()
+{
+    read_symbols();
+    tree_node *root = failure == NULL ? read_tree(AST_KIND_PROGRAM) : NULL;
+    if (failure == NULL && pos != end)
+        fail("binary AST: trailing data after program");
+    return failure == NULL ? static_cast<Program>(root) : NULL;
+}
@@ -0,0 +1,421 @@
+#ifndef AST_BINARY_H
+#define AST_BINARY_H
+//
+// ast-binary.h
+//
+// Compact binary encoding of the AST, an alternative to the indented text
+// written by dump_with_types. The parser writes it (PA3/binary-parser-phase.cc)
+// and the semantic analyzer reads it back with ast_reader (ast-binary.cc)
+// without re-lexing and re-parsing text. PA3/ast-binary.h includes this
+// file, so the writer and reader always agree on the format.
+//
+// Layout (all integers are unsigned LEB128 varints):
+//
+//    magic         "COOLAST" followed by the format version byte
+//    symbols       count, then per symbol: table, length, bytes
+//                  (table is one of the AST_*_TABLE values below)
+//    nodes         the program node, in preorder
+//
+// Each node record is
+//
+//    tag line field...
+//
+// where tag is one of the AST_* constructor tags and line is the node's
+// line number. Fields follow in cool-tree.aps order: a Symbol is its index
+// in the symbol section, a Boolean is 0 or 1, a child node is its own record
+// and a list is its length followed by the element records. Expression
+// records end with their type: 0 for none, otherwise symbol index + 1.
+//
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "cool-io.h"
+#include "stringtab.h"
+#include "tree.h"
+
+class Program_class;
+class Class__class;
+class Feature_class;
+class Formal_class;
+class Case_class;
+class Expression_class;
+
+#define AST_BINARY_MAGIC "COOLAST"
+#define AST_BINARY_VERSION 1
+
+// Symbol tables
+#define AST_ID_TABLE      0
+#define AST_INT_TABLE     1
+#define AST_STRING_TABLE  2
+
+// Constructor tags, in cool-tree.aps order
+enum ast_tag {
+    AST_PROGRAM = 1,
+    AST_CLASS,
+    AST_METHOD,
+    AST_ATTR,
+    AST_FORMAL,
+    AST_BRANCH,
+    AST_ASSIGN,
+    AST_STATIC_DISPATCH,
+    AST_DISPATCH,
+    AST_COND,
+    AST_LOOP,
+    AST_TYPCASE,
+    AST_BLOCK,
+    AST_LET,
+    AST_PLUS,
+    AST_SUB,
+    AST_MUL,
+    AST_DIVIDE,
+    AST_NEG,
+    AST_LT,
+    AST_EQ,
+    AST_LEQ,
+    AST_COMP,
+    AST_INT_CONST,
+    AST_BOOL_CONST,
+    AST_STRING_CONST,
+    AST_NEW,
+    AST_ISVOID,
+    AST_NO_EXPR,
+    AST_OBJECT
+};
+
+/*
+ * The fields of a node as its fields() method (cool-tree.handcode.h) lists
+ * them: in cool-tree.aps order, with each list as its length, its elements
+ * and an end marker, and an expression's type last. Listing the fields of
+ * a node does not descend into its children, so ast_walk can visit a tree
+ * of any depth from a stack of its own.
+ */
+class ast_fields {
+public:
+    enum kind { SYMBOL, BOOLEAN, CHILD, LIST, END_LIST, TYPE };
+    struct item {
+        kind k;
+        int value;                          // a SYMBOL's table, a BOOLEAN,
+                                            // or a LIST's length
+        Symbol symbol;                      // of a SYMBOL or TYPE
+        tree_node *child;
+        ast_tag (*child_fields)(tree_node *, ast_fields&);
+    };
+    std::vector<item> items;
+
+private:
+    template <class Node>
+    static ast_tag fields_of(tree_node *t, ast_fields& f)
+        { return static_cast<Node>(t)->fields(f); }
+
+    item& add(kind k, int value = 0) {
+        item i = { k, value, NULL, NULL, NULL };
+        items.push_back(i);
+        return items.back();
+    }
+
+public:
+    void symbol(Symbol s, int table = AST_ID_TABLE) { add(SYMBOL, table).symbol = s; }
+    void boolean(bool b) { add(BOOLEAN, b ? 1 : 0); }
+    template <class Node> void child(Node t) {
+        item& i = add(CHILD);
+        i.child = t;
+        i.child_fields = &fields_of<Node>;
+    }
+    template <class Elem> void list(list_node<Elem> *l) {
+        int n = l->len();
+        add(LIST, n);
+        for (int i = 0; i < n; i++)
+            child(l->nth(i));
+        add(END_LIST);
+    }
+    void type(Symbol s) { add(TYPE).symbol = s; }
+};
+
+struct ast_walk_frame {
+    tree_node *t;
+    ast_tag tag;
+    size_t start;               // of its fields in ast_fields::items
+    size_t next;                // the next of them to visit
+    int depth;
+};
+
+/*
+ * Visits root and the nodes below it in preorder, keeping the nodes it is
+ * in the middle of on a stack of its own, so that a chain of expressions
+ * nested hundreds of thousands deep takes no native stack. The visitor is
+ * called back with
+ *
+ *    node(tag, t, depth)                  as a node is entered
+ *    symbol(owner, s, table, depth)       for each field of the owner's tag
+ *    boolean(owner, b, depth)
+ *    list(owner, t, length, depth)        before the elements of a list
+ *    end_list(owner, t, depth)            and after them
+ *    type(t, type, depth)                 after an expression's fields
+ *
+ * where depth starts at the given one and grows by two per level, as the
+ * indentation of dump_with_types does.
+ */
+template <class Node, class Visitor>
+void ast_walk(Node root, Visitor& v, int depth = 0)
+{
+    ast_fields f;
+    std::vector<ast_walk_frame> stack;
+    ast_walk_frame top = { root, root->fields(f), 0, 0, depth };
+    v.node(top.tag, root, depth);
+    stack.push_back(top);
+    while (!stack.empty()) {
+        ast_walk_frame& w = stack.back();
+        if (w.next == f.items.size()) {
+            f.items.resize(w.start);
+            stack.pop_back();
+            continue;
+        }
+        ast_fields::item i = f.items[w.next++];
+        int d = w.depth + 2;
+        switch (i.k) {
+        case ast_fields::SYMBOL:
+            v.symbol(w.tag, i.symbol, i.value, d);
+            break;
+        case ast_fields::BOOLEAN:
+            v.boolean(w.tag, i.value != 0, d);
+            break;
+        case ast_fields::LIST:
+            v.list(w.tag, w.t, i.value, d);
+            break;
+        case ast_fields::END_LIST:
+            v.end_list(w.tag, w.t, d);
+            break;
+        case ast_fields::TYPE:
+            v.type(w.t, i.symbol, w.depth);
+            break;
+        case ast_fields::CHILD: {
+            ast_walk_frame c = { i.child, AST_PROGRAM, f.items.size(), f.items.size(), d };
+            c.tag = i.child_fields(i.child, f);
+            v.node(c.tag, c.t, d);
+            stack.push_back(c);
+            break;
+        }
+        }
+    }
+}
+
+/*
+ * Accumulates node records in memory while assigning symbol indices, then
+ * writes the symbol section followed by the records. The nodes' dump_binary
+ * methods (cool-tree.handcode.h) walk the tree with ast_walk and write each
+ * record through an ast_record_writer. Everything is inline so the tree
+ * package links without an extra object.
+ */
+class ast_writer {
+private:
+    std::string nodes;
+    std::vector<std::pair<Symbol, unsigned> > symbol_index;    // open addressing
+    std::vector<std::pair<int, Symbol> > symbols;
+    int line_base;
+    std::vector<std::pair<ast_tag, tree_node *> > *visited;
+
+    static void varint(std::string& buf, unsigned value) {
+        while (value >= 0x80) {
+            buf += (char) ((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        buf += (char) value;
+    }
+
+    unsigned index_of(Symbol s, int table) {
+        if (symbols.size() * 2 >= symbol_index.size())
+            grow_index();
+        size_t mask = symbol_index.size() - 1;
+        size_t i = ((size_t) s >> 4) & mask;
+        while (symbol_index[i].first != NULL) {
+            if (symbol_index[i].first == s)
+                return symbol_index[i].second;
+            i = (i + 1) & mask;
+        }
+        unsigned index = symbols.size();
+        symbol_index[i] = std::make_pair(s, index);
+        symbols.push_back(std::make_pair(table, s));
+        return index;
+    }
+
+    void write_header(std::string& out) {
+        out.assign(AST_BINARY_MAGIC);
+        out += (char) AST_BINARY_VERSION;
+        varint(out, symbols.size());
+        for (size_t i = 0; i < symbols.size(); i++) {
+            Symbol s = symbols[i].second;
+            varint(out, symbols[i].first);
+            varint(out, s->get_len());
+            out.append(s->get_string(), s->get_len());
+        }
+    }
+
+    void grow_index() {
+        std::vector<std::pair<Symbol, unsigned> > old;
+        old.swap(symbol_index);
+        symbol_index.resize(old.empty() ? 64 : old.size() * 2, std::make_pair((Symbol) NULL, 0u));
+        size_t mask = symbol_index.size() - 1;
+        for (size_t j = 0; j < old.size(); j++) {
+            if (old[j].first == NULL)
+                continue;
+            size_t i = ((size_t) old[j].first >> 4) & mask;
+            while (symbol_index[i].first != NULL)
+                i = (i + 1) & mask;
+            symbol_index[i] = old[j];
+        }
+    }
+
+public:
+    ast_writer() : line_base(0), visited(NULL) { }
+
+    // Starts over, keeping the memory, to write another tree.
+    void clear() {
+        nodes.clear();
+        symbols.clear();
+        std::fill(symbol_index.begin(), symbol_index.end(), std::make_pair((Symbol) NULL, 0u));
+    }
+
+    // Writes line numbers relative to base, so that a subtree can be
+    // compared with an earlier copy of itself that has since moved.
+    void relative_to(int base) { line_base = base; }
+    // Appends every node written to v, in preorder.
+    void collect(std::vector<std::pair<ast_tag, tree_node *> > *v) { visited = v; }
+
+    void node(ast_tag tag, tree_node *t) {
+        varint(nodes, tag);
+        varint(nodes, t->get_line_number() - line_base);
+        if (visited != NULL)
+            visited->push_back(std::make_pair(tag, t));
+    }
+    void symbol(Symbol s, int table = AST_ID_TABLE) { varint(nodes, index_of(s, table)); }
+    void boolean(bool b) { varint(nodes, b ? 1 : 0); }
+    void length(int n) { varint(nodes, n); }
+    void type(Symbol s) { varint(nodes, s == NULL ? 0 : index_of(s, AST_ID_TABLE) + 1); }
+
+    /* Writes the header and symbol section, then the buffered node records. */
+    void finish(ostream& out) {
+        std::string header;
+        write_header(header);
+        out.write(header.data(), header.size());
+        out.write(nodes.data(), nodes.size());
+        out.flush();
+    }
+
+    /* finish() into a string, replacing its contents. */
+    void finish(std::string& out) {
+        write_header(out);
+        out.append(nodes);
+    }
+};
+
+/* ast_walk visitor that writes the record of each node it visits. */
+class ast_record_writer {
+private:
+    ast_writer& w;
+
+public:
+    ast_record_writer(ast_writer& writer) : w(writer) { }
+
+    void node(ast_tag tag, tree_node *t, int) { w.node(tag, t); }
+    void symbol(ast_tag, Symbol s, int table, int) { w.symbol(s, table); }
+    void boolean(ast_tag, bool b, int) { w.boolean(b); }
+    void list(ast_tag, tree_node *, int length, int) { w.length(length); }
+    void end_list(ast_tag, tree_node *, int) { }
+    void type(tree_node *, Symbol s, int) { w.type(s); }
+};
+
+/*
+ * Field kinds of each node record, indexed by tag: S(ymbol), B(oolean),
+ * N(ode) and L(ist), in cool-tree.aps order. NULL for an unknown tag.
+ */
+const char *ast_schema(unsigned tag);
+
+// Kinds of node a record or link may hold
+enum ast_kind {
+    AST_KIND_PROGRAM,
+    AST_KIND_CLASS,
+    AST_KIND_FEATURE,
+    AST_KIND_FORMAL,
+    AST_KIND_CASE,
+    AST_KIND_EXPRESSION
+};
+
+bool ast_tag_has_kind(unsigned tag, ast_kind kind);
+ast_kind ast_child_kind(unsigned tag, char field);   // of tag's N or L fields
+
+/*
+ * Builds AST nodes bottom up, for readers that keep an explicit stack of
+ * the records they are in the middle of rather than read each child by
+ * recursion, which takes a native stack frame per level of nesting. The
+ * fields of a record are added in schema order as they are read, each
+ * child once it has been built and each list once all its elements have
+ * been added; build() then replaces them with the node. Lists are built as
+ * balanced trees of append nodes so that nth(), which walks down the tree,
+ * stays logarithmic for long lists.
+ */
+class ast_builder {
+private:
+    union value {
+        Symbol symbol;
+        tree_node *node;
+        bool boolean;
+    };
+    std::vector<value> values;
+
+    void push(value v) { values.push_back(v); }
+
+public:
+    // Where the next field goes, to mark the start of a record or list.
+    size_t mark() const { return values.size(); }
+    void symbol(Symbol s) { value v; v.symbol = s; push(v); }
+    void boolean(bool b) { value v; v.boolean = b; push(v); }
+    void node(tree_node *t) { value v; v.node = t; push(v); }
+    // Replaces the nodes added since start with a list of them, as the L
+    // field of a tag record.
+    void list(unsigned tag, size_t start);
+    // Replaces the fields added since start with a node of tag, which must
+    // have a schema; type is set on expressions.
+    tree_node *build(unsigned tag, int line, size_t start, Symbol type);
+    void clear() { values.clear(); }
+};
+
+/*
+ * Rebuilds an AST from its binary encoding. The input must stay valid for
+ * the lifetime of the reader; symbols are interned into the usual tables.
+ * read() returns NULL if the input is malformed, and error() then says
+ * what was wrong with it.
+ */
+class ast_reader {
+private:
+    struct frame {
+        unsigned tag;
+        int line;
+        const char *field;      // the next field of its schema
+        size_t start;           // of its fields in the builder
+        bool in_list;           // if reading the elements of a list
+        size_t list;            // where they start in the builder
+        unsigned list_left;     // elements of the list still to read
+    };
+    const unsigned char *pos;
+    const unsigned char *end;
+    std::vector<Symbol> symbols;
+    const char *failure;        // the first error, NULL if none
+    std::vector<frame> stack;
+    ast_builder builder;
+
+    void fail(const char *message);
+    unsigned varint();
+    Symbol symbol();
+    Symbol type();
+    void read_symbols();
+    void open(ast_kind kind);
+    tree_node *read_tree(ast_kind kind);
+
+public:
+    ast_reader(const char *data, size_t size);
+    Program_class *read();
+    const char *error() const { return failure; }
+};
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * ast-image-phase.cc
+ *          Converts a binary AST into an AST image.
+ *
+ * Reads the output of PA3's binary-parser on standard input and writes the
+ * equivalent mmap-able image (see ast-image.h) to standard output. Build it
+ * with
+ *
+ *      g++ -g -Wall -Wno-unused -Wno-write-strings -I. \
+ *          -I/usr/class/cs143/cool/include/PA4 -I/usr/class/cs143/cool/src/PA4 \
+ *          ast-image-phase.cc ast-image.cc ast-binary.cc semant.o utilities.o \
+ *          stringtab.o tree.o cool-tree.o dumptype.o -lpthread -o ast-image
+ *
+ * and use it as
+ *
+ *      lexer foo.cl | binary-parser | ast-image > foo.img
+ *      image-semant < foo.img
+ */
+#include <stdlib.h>
+#include <string>
+#include <iterator>
+#include "cool-tree.h"
+#include "ast-image.h"
+
+int main(int argc, char *argv[]) {
+    std::string data((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+    std::string image;
+    if (!ast_image_from_binary(data.data(), data.size(), image)) {
+        cerr << "ast-image: malformed binary AST on standard input\n";
+        exit(1);
+    }
+    cout.write(image.data(), image.size());
+    return 0;
+}
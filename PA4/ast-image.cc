@@ -0,0 +1,568 @@
+//
+// ast-image.cc
+//
+// Conversion from the binary AST stream to an AST image, and the mmap-based
+// reader and node views described in ast-image.h.
+//
+
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cool-tree.h"
+#include "ast-image.h"
+
+// Header words
+#define HDR_MAGIC        0
+#define HDR_BYTE_ORDER   2
+#define HDR_VERSION      3
+#define HDR_SYMBOL_COUNT 4
+#define HDR_SYMBOLS      5
+#define HDR_ROOT         6
+#define HDR_SIZE         7
+#define HDR_WORDS        8
+
+/////////////////////////////////////////////////////////////////////
+//
+// Binary stream to image
+//
+/////////////////////////////////////////////////////////////////////
+
+/*
+ * Decodes the varints of a binary AST stream. Errors are sticky: once ok is
+ * false every read returns 0, so callers check it once at the end.
+ */
+struct binary_cursor {
+    const unsigned char *pos;
+    const unsigned char *end;
+    bool ok;
+
+    unsigned varint() {
+        unsigned value = 0;
+        for (int shift = 0; ok && shift < 35; shift += 7) {
+            if (pos == end)
+                break;
+            unsigned char b = *pos++;
+            value |= (unsigned) (b & 0x7f) << shift;
+            if ((b & 0x80) == 0)
+                return value;
+        }
+        ok = false;
+        return 0;
+    }
+};
+
+static uint32_t relative(size_t from, size_t to)
+{
+    return (uint32_t) ((int32_t) (to - from) * 4);
+}
+
+/*
+ * A record being copied by emit_tree: where it starts in words, its next
+ * field, and the list record whose elements it is copying, if any.
+ */
+struct emit_frame {
+    size_t at;
+    const char *schema;
+    size_t field;
+    size_t list;
+    unsigned elem, len;
+};
+
+/*
+ * Starts copying the next record of the binary stream to the end of words,
+ * linking it from words[link] unless link is 0.
+ */
+static void emit_record(binary_cursor& in, std::vector<uint32_t>& words,
+                        std::vector<emit_frame>& stack, size_t link)
+{
+    unsigned tag = in.varint();
+    unsigned line = in.varint();
+    const char *schema = ast_schema(tag);
+    if (schema == NULL || !in.ok) {
+        in.ok = false;
+        return;
+    }
+
+    emit_frame f;
+    f.at = words.size();
+    f.schema = schema;
+    f.field = 0;
+    f.list = 0;
+    f.elem = f.len = 0;
+    words.resize(f.at + 3 + strlen(schema));
+    words[f.at] = tag;
+    words[f.at + 1] = line;
+    words[f.at + 2] = 0;
+    if (link != 0)
+        words[link] = relative(link, f.at);
+    stack.push_back(f);
+}
+
+/*
+ * Copies the node records of the binary stream, parent before children, to
+ * the end of words, returning the index of the root record's first word.
+ * Words are addressed by index since the vector grows underneath. The
+ * records being copied are kept on an explicit stack, as in ast_reader, so
+ * that nesting costs no native stack.
+ */
+static size_t emit_tree(binary_cursor& in, unsigned symbol_count, std::vector<uint32_t>& words)
+{
+    std::vector<emit_frame> stack;
+    size_t root = words.size();
+    emit_record(in, words, stack, 0);
+    while (!stack.empty() && in.ok) {
+        emit_frame& f = stack.back();
+        if (f.elem < f.len) {
+            size_t slot = f.list + 1 + f.elem++;
+            emit_record(in, words, stack, slot);
+            continue;
+        }
+        char kind = f.schema[f.field];
+        if (kind == '\0') {
+            if (words[f.at] >= AST_ASSIGN) {
+                words[f.at + 2] = in.varint();
+                if (words[f.at + 2] > symbol_count)
+                    in.ok = false;
+            }
+            stack.pop_back();
+            continue;
+        }
+
+        size_t field = f.at + 3 + f.field++;
+        switch (kind) {
+        case 'S':
+            words[field] = in.varint();
+            if (words[field] >= symbol_count)
+                in.ok = false;
+            break;
+        case 'B':
+            words[field] = in.varint();
+            if (words[field] > 1)
+                in.ok = false;
+            break;
+        case 'N':
+            emit_record(in, words, stack, field);
+            break;
+        case 'L': {
+            unsigned len = in.varint();
+            if ((size_t) (in.end - in.pos) < len)   // every element is > 1 byte
+                in.ok = false;
+            if (!in.ok)
+                break;
+            f.list = words.size();
+            f.elem = 0;
+            f.len = len;
+            words.resize(f.list + 1 + len);
+            words[f.list] = len;
+            words[field] = relative(field, f.list);
+            break;
+        }
+        }
+    }
+    return root;
+}
+
+bool ast_image_from_binary(const char *data, size_t size, std::string& image)
+{
+    binary_cursor in;
+    in.pos = (const unsigned char *) data;
+    in.end = in.pos + size;
+    in.ok = true;
+
+    size_t magic_len = strlen(AST_BINARY_MAGIC);
+    if (size < magic_len + 1 || memcmp(data, AST_BINARY_MAGIC, magic_len) != 0 ||
+        (unsigned char) data[magic_len] != AST_BINARY_VERSION)
+        return false;
+    in.pos += magic_len + 1;
+
+    // Symbol section: remember where each symbol's text is in the input.
+    unsigned symbol_count = in.varint();
+    std::vector<uint32_t> symbol_tables;
+    std::vector<const unsigned char *> symbol_text;
+    std::vector<uint32_t> symbol_lengths;
+    for (unsigned i = 0; i < symbol_count && in.ok; i++) {
+        symbol_tables.push_back(in.varint());
+        unsigned len = in.varint();
+        if ((size_t) (in.end - in.pos) < len)
+            return false;
+        symbol_text.push_back(in.pos);
+        symbol_lengths.push_back(len);
+        in.pos += len;
+    }
+    if (!in.ok)
+        return false;
+
+    std::vector<uint32_t> words(HDR_WORDS);
+    size_t root = emit_tree(in, symbol_count, words);
+    if (!in.ok || in.pos != in.end)
+        return false;
+
+    // Symbol entries, then the text they point at.
+    size_t symbols = words.size();
+    size_t text_offset = (symbols + 3 * symbol_count) * 4;
+    for (unsigned i = 0; i < symbol_count; i++) {
+        words.push_back(symbol_tables[i]);
+        words.push_back(symbol_lengths[i]);
+        words.push_back(text_offset);
+        text_offset += symbol_lengths[i] + 1;
+    }
+
+    memcpy(&words[HDR_MAGIC], AST_IMAGE_MAGIC, 8);
+    words[HDR_BYTE_ORDER] = AST_IMAGE_BYTE_ORDER;
+    words[HDR_VERSION] = AST_IMAGE_VERSION;
+    words[HDR_SYMBOL_COUNT] = symbol_count;
+    words[HDR_SYMBOLS] = symbols * 4;
+    words[HDR_ROOT] = root * 4;
+    words[HDR_SIZE] = text_offset;
+
+    image.assign((const char *) &words[0], words.size() * 4);
+    image.reserve(text_offset);
+    for (unsigned i = 0; i < symbol_count; i++) {
+        image.append((const char *) symbol_text[i], symbol_lengths[i]);
+        image += '\0';
+    }
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// Image reader and views
+//
+/////////////////////////////////////////////////////////////////////
+
+Symbol ast_node_view::type() const
+{
+    return record[2] == 0 ? NULL : image->symbol(record[2] - 1);
+}
+
+Symbol ast_node_view::symbol(int n) const
+{
+    return image->symbol(*field(n));
+}
+
+const char *ast_node_view::text(int n) const
+{
+    return image->symbol_text(*field(n));
+}
+
+ast_node_view ast_node_view::list_elem(int n, int i) const
+{
+    const uint32_t *list = follow(field(n));
+    return ast_node_view(image, follow(list + 1 + i));
+}
+
+ast_image::ast_image()
+{
+    base = NULL;
+    size = 0;
+    mapped = false;
+    symbol_entries = NULL;
+    symbol_count = 0;
+}
+
+ast_image::~ast_image()
+{
+    close();
+}
+
+bool ast_image::open(const char *path)
+{
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    bool ok = open(fd);
+    ::close(fd);
+    return ok;
+}
+
+/* Maps the whole file behind fd; the descriptor may be closed afterwards. */
+bool ast_image::open(int fd)
+{
+    close();
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+        return false;
+    void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED)
+        return false;
+    base = (const char *) p;
+    size = st.st_size;
+    mapped = true;
+    if (!validate()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+/* Uses an image already in memory, which must be 4-byte aligned. */
+bool ast_image::open(const char *data, size_t len)
+{
+    close();
+    base = data;
+    size = len;
+    if (!validate()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void ast_image::close()
+{
+    if (mapped)
+        munmap((void *) base, size);
+    base = NULL;
+    size = 0;
+    mapped = false;
+    symbols.clear();
+}
+
+/*
+ * Walks the node section in the order ast_image_from_binary lays it out:
+ * a record, then the children of its fields in order, each list record
+ * just before its elements. Every link must point at the next unvisited
+ * word, which keeps every read inside the node section, rules out cycles
+ * and shared subtrees, and makes the check linear in the image size. The
+ * records being checked are kept on an explicit stack, as in emit_tree.
+ */
+struct image_checker {
+    struct frame {
+        size_t at;
+        unsigned tag;
+        const char *schema;
+        size_t field;
+        size_t list;
+        uint32_t elem, len;
+    };
+    const uint32_t *words;
+    size_t next;                // where the next record must start
+    size_t end;                 // first word past the node section
+    unsigned symbol_count;
+    std::vector<frame> stack;
+
+    bool link(size_t field) const {
+        int32_t offset = (int32_t) words[field];
+        return offset % 4 == 0 && (ptrdiff_t) field + offset / 4 == (ptrdiff_t) next;
+    }
+    bool open(ast_kind kind);
+    bool tree(ast_kind kind);
+};
+
+/* Checks the record at next and starts on its fields. */
+bool image_checker::open(ast_kind kind)
+{
+    size_t at = next;
+    if (end - at < 3)
+        return false;
+    unsigned tag = words[at];
+    const char *schema = ast_schema(tag);
+    if (schema == NULL || !ast_tag_has_kind(tag, kind))
+        return false;
+    size_t nfields = strlen(schema);
+    if (end - at - 3 < nfields || words[at + 2] > symbol_count ||
+        (tag < AST_ASSIGN && words[at + 2] != 0))
+        return false;
+    next = at + 3 + nfields;
+
+    frame f;
+    f.at = at;
+    f.tag = tag;
+    f.schema = schema;
+    f.field = 0;
+    f.list = 0;
+    f.elem = f.len = 0;
+    stack.push_back(f);
+    return true;
+}
+
+/* Checks the record at next, of the given kind, and its subtree. */
+bool image_checker::tree(ast_kind kind)
+{
+    stack.clear();
+    if (!open(kind))
+        return false;
+    while (!stack.empty()) {
+        frame& f = stack.back();
+        if (f.elem < f.len) {
+            size_t slot = f.list + 1 + f.elem++;
+            if (!link(slot) || !open(ast_child_kind(f.tag, 'L')))
+                return false;
+            continue;
+        }
+        char kind = f.schema[f.field];
+        if (kind == '\0') {
+            stack.pop_back();
+            continue;
+        }
+
+        size_t field = f.at + 3 + f.field++;
+        switch (kind) {
+        case 'S':
+            if (words[field] >= symbol_count)
+                return false;
+            break;
+        case 'B':
+            if (words[field] > 1)
+                return false;
+            break;
+        case 'N':
+            if (!link(field) || !open(ast_child_kind(f.tag, 'N')))
+                return false;
+            break;
+        case 'L':
+            if (!link(field) || next == end)
+                return false;
+            f.list = next;
+            f.elem = 0;
+            f.len = words[f.list];
+            if (end - f.list - 1 < f.len)
+                return false;
+            next = f.list + 1 + f.len;
+            break;
+        }
+    }
+    return true;
+}
+
+/*
+ * Checks the header, the symbol table and every node record, so that no
+ * view or symbol lookup can read outside the image however it was made.
+ */
+bool ast_image::validate()
+{
+    const uint32_t *header = (const uint32_t *) base;
+    if (size < HDR_WORDS * 4 || memcmp(base, AST_IMAGE_MAGIC, 8) != 0 ||
+        header[HDR_BYTE_ORDER] != AST_IMAGE_BYTE_ORDER ||
+        header[HDR_VERSION] != AST_IMAGE_VERSION || header[HDR_SIZE] != size)
+        return false;
+
+    symbol_count = header[HDR_SYMBOL_COUNT];
+    size_t symbols_at = header[HDR_SYMBOLS];
+    if (symbols_at % 4 != 0 || symbols_at + (size_t) symbol_count * 12 > size ||
+        header[HDR_ROOT] != HDR_WORDS * 4 || header[HDR_ROOT] >= symbols_at)
+        return false;
+    symbol_entries = (const uint32_t *) (base + symbols_at);
+    for (unsigned i = 0; i < symbol_count; i++) {
+        const uint32_t *entry = symbol_entries + 3 * i;
+        if (entry[0] > AST_STRING_TABLE || (size_t) entry[2] + entry[1] >= size ||
+            base[entry[2] + entry[1]] != '\0')
+            return false;
+    }
+
+    image_checker check;
+    check.words = header;
+    check.next = HDR_WORDS;
+    check.end = symbols_at / 4;
+    check.symbol_count = symbol_count;
+    if (!check.tree(AST_KIND_PROGRAM) || check.next != check.end)
+        return false;
+
+    symbols.assign(symbol_count, (Symbol) NULL);
+    return true;
+}
+
+ast_node_view ast_image::root() const
+{
+    const uint32_t *header = (const uint32_t *) base;
+    return ast_node_view(this, (const uint32_t *) (base + header[HDR_ROOT]));
+}
+
+const char *ast_image::symbol_text(unsigned index) const
+{
+    return base + symbol_entries[3 * index + 2];
+}
+
+Symbol ast_image::symbol(unsigned index) const
+{
+    if (symbols[index] != NULL)
+        return symbols[index];
+    const uint32_t *entry = symbol_entries + 3 * index;
+    char *str = const_cast<char *>(symbol_text(index));
+    switch (entry[0]) {
+    case AST_ID_TABLE:  symbols[index] = idtable.add_string(str, entry[1]); break;
+    case AST_INT_TABLE: symbols[index] = inttable.add_string(str, entry[1]); break;
+    default:            symbols[index] = stringtable.add_string(str, entry[1]); break;
+    }
+    return symbols[index];
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// Building cool-tree.h nodes from views
+//
+/////////////////////////////////////////////////////////////////////
+
+/*
+ * A record being built by ast_image::build: its view, its next field, and
+ * the list whose elements it is building, if any.
+ */
+struct build_frame {
+    ast_node_view v;
+    size_t start;               // of its fields in the builder
+    int field;
+    bool in_list;
+    size_t list;                // where the list starts in the builder
+    int list_field, elem, len;
+
+    build_frame(ast_node_view view, size_t s)
+        : v(view), start(s), field(0), in_list(false), list(0), list_field(0), elem(0), len(0) { }
+};
+
+/*
+ * Builds the tree with an explicit stack of the records in the middle of
+ * being built, as ast_reader does from a binary stream (see ast_builder).
+ */
+Program ast_image::build() const
+{
+    ast_builder builder;
+    std::vector<build_frame> stack;
+    stack.push_back(build_frame(root(), builder.mark()));
+    for (;;) {
+        build_frame& f = stack.back();
+        if (f.in_list) {
+            if (f.elem < f.len) {
+                ast_node_view elem = f.v.list_elem(f.list_field, f.elem++);
+                stack.push_back(build_frame(elem, builder.mark()));
+                continue;
+            }
+            builder.list(f.v.tag(), f.list);
+            f.in_list = false;
+            continue;
+        }
+
+        char kind = ast_schema(f.v.tag())[f.field];
+        if (kind == '\0') {
+            tree_node *node = builder.build(f.v.tag(), f.v.line(), f.start, f.v.type());
+            stack.pop_back();
+            if (stack.empty())
+                return static_cast<Program>(node);
+            builder.node(node);
+            continue;
+        }
+        int n = f.field++;
+        switch (kind) {
+        case 'S':
+            builder.symbol(f.v.symbol(n));
+            break;
+        case 'B':
+            builder.boolean(f.v.boolean(n));
+            break;
+        case 'N': {
+            ast_node_view child = f.v.child(n);
+            stack.push_back(build_frame(child, builder.mark()));
+            break;
+        }
+        case 'L':
+            f.in_list = true;
+            f.list = builder.mark();
+            f.list_field = n;
+            f.elem = 0;
+            f.len = f.v.list_length(n);
+            break;
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef AST_IMAGE_H
+#define AST_IMAGE_H
+//
+// ast-image.h
+//
+// An AST image is a pointer-free, fixed-layout form of the binary AST
+// (ast-binary.h) meant to be mmap'ed and read in place. Every value is a
+// 32-bit word in host byte order, so an image is a local cache rather than
+// an exchange format; the header records the byte order and is checked on
+// open.
+//
+// Layout (offsets in bytes from the start of the image):
+//
+//    header        magic "COOLIMG\0", byte order word, version,
+//                  symbol count, symbol table offset, root node offset
+//    nodes         node records, parent before children
+//    symbols       per symbol: table, length, offset of its text
+//    text          symbol text, each NUL-terminated
+//
+// A node record is
+//
+//    tag line type field...
+//
+// where type is 0 or a symbol index + 1 (expressions only). Fields follow
+// the record schema of the tag (ast_schema in ast-binary.h): a Symbol is a
+// symbol index, a Boolean is 0 or 1, and a child node or list is a signed
+// offset from the field itself to the child's record. A list record is its
+// length followed by one relative offset per element.
+//
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ast-binary.h"
+
+#define AST_IMAGE_MAGIC "COOLIMG"
+#define AST_IMAGE_BYTE_ORDER 0x01020304
+#define AST_IMAGE_VERSION 1
+
+class ast_image;
+
+/*
+ * A read-only view of one node record inside an image. Views are two words
+ * and are passed by value; fields are decoded only when asked for.
+ */
+class ast_node_view {
+private:
+    const ast_image *image;
+    const uint32_t *record;
+
+    const uint32_t *field(int n) const { return record + 3 + n; }
+    const uint32_t *follow(const uint32_t *p) const
+        { return (const uint32_t *) ((const char *) p + (int32_t) *p); }
+
+public:
+    ast_node_view(const ast_image *i, const uint32_t *r) : image(i), record(r) { }
+
+    ast_tag tag() const { return (ast_tag) record[0]; }
+    int line() const { return record[1]; }
+    Symbol type() const;
+    Symbol symbol(int n) const;
+    const char *text(int n) const;      // a symbol's text, without interning it
+    bool boolean(int n) const { return *field(n) != 0; }
+    ast_node_view child(int n) const { return ast_node_view(image, follow(field(n))); }
+    int list_length(int n) const { return *follow(field(n)); }
+    ast_node_view list_elem(int n, int i) const;
+};
+
+/*
+ * An AST image opened from a file or file descriptor with mmap. open()
+ * checks every record and link against the mapping, so views of an image
+ * that opened can be followed without further checks. Symbols are
+ * interned into the string tables the first time a view asks for them.
+ */
+class ast_image {
+private:
+    const char *base;
+    size_t size;
+    bool mapped;
+    const uint32_t *symbol_entries;
+    unsigned symbol_count;
+    mutable std::vector<Symbol> symbols;
+
+    bool validate();
+
+public:
+    ast_image();
+    ~ast_image();
+
+    bool open(const char *path);
+    bool open(int fd);
+    bool open(const char *data, size_t size);
+    void close();
+
+    ast_node_view root() const;
+    Symbol symbol(unsigned index) const;
+    const char *symbol_text(unsigned index) const;
+
+    // Builds cool-tree.h nodes from the image, for passes that walk the tree.
+    Program_class *build() const;
+};
+
+/*
+ * Converts a binary AST stream into an image. Returns false if the stream
+ * is malformed.
+ */
+bool ast_image_from_binary(const char *data, size_t size, std::string& image);
+
+#endif
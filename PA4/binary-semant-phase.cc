@@ -0,0 +1,58 @@
+/*
+ * binary-semant-phase.cc
+ *          Semantic analysis driver that reads the binary AST.
+ *
+ * A replacement for semant-phase.cc that takes the output of PA3's
+ * binary-parser (see ast-binary.h) on standard input instead of the text
+ * AST. The program is analyzed as usual and the typed AST is written to
+ * standard output as dump_with_types text, ready for cgen.
+ * When COOL_SEMANT_STREAM is set, each class is written as soon as it has
+ * been checked (see program_class::semant_streaming), so that cgen can
+ * start reading while semant is still at work; on semantic errors the
+ * stream ends with SEMANT_STREAM_HALTED (see semant.h).
+ *
+ * Build it from the objects of `make semant', substituting this file and
+ * ast-binary.cc for semant-phase.o, e.g.
+ *
+ *      g++ -g -Wall -Wno-unused -Wno-write-strings -I. \
+ *          -I/usr/class/cs143/cool/include/PA4 -I/usr/class/cs143/cool/src/PA4 \
+ *          binary-semant-phase.cc ast-binary.cc semant.o ast-lex.o ast-parse.o \
+ *          handle_flags.o utilities.o stringtab.o tree.o cool-tree.o dumptype.o \
+ *          -lpthread -o binary-semant
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <iterator>
+#include "cool-tree.h"
+#include "utilities.h"
+
+//
+// Globals normally provided by semant-phase.cc. The text AST parser is
+// linked only for ast_root and the flags handle_flags sets.
+//
+extern Program ast_root;        // root of the abstract syntax tree
+FILE *ast_file = stdin;         // not used, but needed to link with ast-lex
+int cool_yydebug;               // not used, but needed to link with handle_flags
+char *curr_filename;
+void handle_flags(int argc, char *argv[]);
+
+int main(int argc, char *argv[]) {
+    handle_flags(argc, argv);
+
+    std::string data((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+    ast_reader reader(data.data(), data.size());
+    ast_root = reader.read();
+    if (ast_root == NULL) {
+        cerr << "binary-semant: " << reader.error() << "\n";
+        exit(1);
+    }
+
+    if (getenv("COOL_SEMANT_STREAM") != NULL)
+        ast_root->semant_streaming(cout);
+    else {
+        ast_root->semant();
+        ast_root->dump_with_types(cout, 0);
+    }
+    return 0;
+}
@@ -0,0 +1,278 @@
+//
+// compile-cache.cc
+//
+// The on-disk front-end cache described in compile-cache.h.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <link.h>
+#include <elf.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include "compile-cache.h"
+
+#define CACHE_MAGIC "COOLCACHE1"
+
+static const char *stage_names[CACHE_STAGES] = { "tokens", "ast", "typed" };
+
+const char *cache_stage_name(cache_stage stage)
+{
+    return stage < CACHE_STAGES ? stage_names[stage] : "miss";
+}
+
+/*
+ * Two independent 64-bit hashes over the key material: FNV-1a names the
+ * entry, and a multiply-rotate hash is stored in the entry and checked on
+ * load, so a collision of the first alone can't return the wrong program.
+ */
+struct key_hash {
+    uint64_t fnv;
+    uint64_t mix;
+
+    key_hash() : fnv(14695981039346656037ULL), mix(0x9e3779b97f4a7c15ULL) { }
+
+    void add(const char *p, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            unsigned char c = p[i];
+            fnv = (fnv ^ c) * 1099511628211ULL;
+            mix = ((mix ^ c) * 0xff51afd7ed558ccdULL);
+            mix = (mix << 29) | (mix >> 35);
+        }
+    }
+    void add(const std::string& s) { add(s.data(), s.size() + 1); }   // with the NUL
+};
+
+static bool read_file(const char *path, std::string& data)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+        return false;
+    char buf[65536];
+    size_t n;
+    data.clear();
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        data.append(buf, n);
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+/* Writes data to path through a temporary file and rename. */
+static void write_file(const std::string& path, const std::string& data)
+{
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".tmp.%d", (int) getpid());
+    std::string tmp = path + suffix;
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (f == NULL)
+        return;
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0)
+        unlink(tmp.c_str());
+}
+
+/* Appends the GNU build id note of the main program, if it has one, to id. */
+static int find_build_id(struct dl_phdr_info *info, size_t, void *data)
+{
+    std::string *id = (std::string *) data;
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr) *ph = &info->dlpi_phdr[i];
+        if (ph->p_type != PT_NOTE)
+            continue;
+        const char *p = (const char *) (info->dlpi_addr + ph->p_vaddr);
+        const char *end = p + ph->p_memsz;
+        while (p + sizeof(ElfW(Nhdr)) <= end) {
+            const ElfW(Nhdr) *note = (const ElfW(Nhdr) *) p;
+            const char *name = p + sizeof(ElfW(Nhdr));
+            const char *desc = name + ((note->n_namesz + 3) & ~3);
+            if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 &&
+                memcmp(name, "GNU", 4) == 0 && desc + note->n_descsz <= end) {
+                id->assign(desc, note->n_descsz);
+                return 1;
+            }
+            p = desc + ((note->n_descsz + 3) & ~3);
+        }
+    }
+    return 1;                   // the main program comes first; stop there
+}
+
+const std::string& cache_program_id()
+{
+    static std::string id;
+    if (!id.empty())
+        return id;
+    std::string build_id;
+    dl_iterate_phdr(find_build_id, &build_id);
+    key_hash h;
+    if (!build_id.empty())
+        h.add(build_id.data(), build_id.size());
+    else {
+        std::string exe;
+        if (!read_file("/proc/self/exe", exe))
+            return id;
+        h.add(exe.data(), exe.size());
+    }
+    char hex[40];
+    snprintf(hex, sizeof(hex), "%016llx%016llx", (unsigned long long) h.fnv,
+             (unsigned long long) h.mix);
+    id = hex;
+    return id;
+}
+
+bool compile_cache::open(const char *cache_dir, const std::string& config,
+                         const std::vector<const char *>& files)
+{
+    key.clear();
+    if (cache_dir == NULL || *cache_dir == '\0' || cache_program_id().empty())
+        return false;
+    mkdir(cache_dir, 0777);
+
+    key_hash h;
+    h.add(cache_program_id());
+    h.add(config);
+    std::string source;
+    for (size_t i = 0; i < files.size(); i++) {
+        if (!read_file(files[i], source))
+            return false;
+        h.add(std::string(files[i]));
+        char len[32];
+        snprintf(len, sizeof(len), "%lu", (unsigned long) source.size());
+        h.add(std::string(len));
+        h.add(source.data(), source.size());
+    }
+
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long) h.fnv);
+    dir = cache_dir;
+    key = hex;
+    check = h.mix;
+    return true;
+}
+
+std::string compile_cache::entry_path(cache_stage stage)
+{
+    return dir + "/" + key + "." + stage_names[stage];
+}
+
+bool compile_cache::load(cache_stage stage, std::string& data)
+{
+    if (!enabled())
+        return false;
+    std::string entry;
+    if (!read_file(entry_path(stage).c_str(), entry))
+        return false;
+
+    size_t header = strlen(CACHE_MAGIC) + sizeof(check);
+    if (entry.size() < header || entry.compare(0, strlen(CACHE_MAGIC), CACHE_MAGIC) != 0 ||
+        memcmp(entry.data() + strlen(CACHE_MAGIC), &check, sizeof(check)) != 0)
+        return false;
+    data.assign(entry, header, std::string::npos);
+    return true;
+}
+
+void compile_cache::store(cache_stage stage, const std::string& data)
+{
+    if (!enabled())
+        return;
+    std::string entry(CACHE_MAGIC);
+    entry.append((const char *) &check, sizeof(check));
+    entry += data;
+    write_file(entry_path(stage), entry);
+}
+
+/*
+ * The stats file holds one "<name> <count>" line per stage plus misses. It
+ * is updated under an exclusive lock since CI runs compiles in parallel.
+ */
+void compile_cache::record(cache_stage hit)
+{
+    if (!enabled())
+        return;
+    std::string path = dir + "/stats";
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0666);
+    if (fd < 0)
+        return;
+    flock(fd, LOCK_EX);
+
+    unsigned long counts[CACHE_STAGES + 1] = { 0 };
+    FILE *f = fdopen(fd, "r+");
+    char name[32];
+    unsigned long n;
+    while (fscanf(f, "%31s %lu", name, &n) == 2) {
+        for (int i = 0; i <= CACHE_STAGES; i++) {
+            std::string expected = i < CACHE_STAGES ? std::string(stage_names[i]) + "_hits" : "misses";
+            if (expected == name)
+                counts[i] = n;
+        }
+    }
+    counts[hit]++;
+
+    // If the file can't be emptied, leave the old counts rather than
+    // writing shorter lines over the start of longer ones.
+    rewind(f);
+    if (ftruncate(fd, 0) == 0) {
+        for (int i = 0; i < CACHE_STAGES; i++)
+            fprintf(f, "%s_hits %lu\n", stage_names[i], counts[i]);
+        fprintf(f, "misses %lu\n", counts[CACHE_STAGES]);
+        fflush(f);
+    }
+    flock(fd, LOCK_UN);
+    fclose(f);
+}
+
+//
+// Varint helpers
+//
+
+void cache_put_varint(std::string& buf, unsigned value)
+{
+    while (value >= 0x80) {
+        buf += (char) ((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    buf += (char) value;
+}
+
+void cache_put_string(std::string& buf, const char *s, unsigned len)
+{
+    cache_put_varint(buf, len);
+    buf.append(s, len);
+}
+
+cache_cursor::cache_cursor(const std::string& data)
+{
+    pos = (const unsigned char *) data.data();
+    end = pos + data.size();
+    ok = true;
+}
+
+unsigned cache_cursor::varint()
+{
+    unsigned value = 0;
+    for (int shift = 0; ok && shift < 35; shift += 7) {
+        if (pos == end)
+            break;
+        unsigned char b = *pos++;
+        value |= (unsigned) (b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+            return value;
+    }
+    ok = false;
+    return 0;
+}
+
+std::string cache_cursor::string()
+{
+    unsigned len = varint();
+    if (!ok || (size_t) (end - pos) < len) {
+        ok = false;
+        return std::string();
+    }
+    std::string s((const char *) pos, len);
+    pos += len;
+    return s;
+}
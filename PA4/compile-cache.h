@@ -0,0 +1,84 @@
+#ifndef COMPILE_CACHE_H
+#define COMPILE_CACHE_H
+//
+// compile-cache.h
+//
+// On-disk cache of front-end results for coolc-driver. An entry is keyed by
+// a hash of the compiler's build (cache_program_id), the flags and the name
+// and bytes of every input file, and holds up to three stages:
+//
+//    tokens        the lexer's token stream
+//    ast           the untyped AST from the parser (binary AST format)
+//    typed         the typed AST after semantic analysis (binary AST format)
+//
+// so a repeated compile of unchanged sources starts from the latest stage
+// that is present. Entries are files named <key>.<stage> in the cache
+// directory, written to a temporary name and renamed into place so that
+// concurrent compiles never see a partial entry. Hit and miss counts are
+// kept in the directory's "stats" file.
+//
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+enum cache_stage {
+    CACHE_TOKENS,
+    CACHE_AST,
+    CACHE_TYPED,
+    CACHE_STAGES
+};
+
+class compile_cache {
+private:
+    std::string dir;
+    std::string key;            // hex of the entry hash, used in file names
+    uint64_t check;             // second hash, stored in and checked against entries
+
+    std::string entry_path(cache_stage stage);
+
+public:
+    compile_cache() : check(0) { }
+
+    // Computes the key from the program's build (cache_program_id), config
+    // (the flags) and the input files. Returns false if cache_dir is NULL,
+    // the build can't be identified or an input can't be read, in which
+    // case load and store do nothing.
+    bool open(const char *cache_dir, const std::string& config,
+              const std::vector<const char *>& files);
+    bool enabled() { return !key.empty(); }
+
+    bool load(cache_stage stage, std::string& data);
+    void store(cache_stage stage, const std::string& data);
+
+    // Adds one compile to the stats file: the stage it started from, or
+    // CACHE_STAGES for a full miss.
+    void record(cache_stage hit);
+};
+
+const char *cache_stage_name(cache_stage stage);
+
+// Identifies this build of the whole running program, for cache keys: a
+// hash of the GNU build id the linker computes over the linked image, or of
+// the executable itself for a program linked without one. Relinking any
+// object into the program changes it. Empty if neither can be read.
+const std::string& cache_program_id();
+
+//
+// Varint helpers shared by the cache entry encoders and the compile server
+// protocol (compile-server.h).
+//
+void cache_put_varint(std::string& buf, unsigned value);
+void cache_put_string(std::string& buf, const char *s, unsigned len);
+
+struct cache_cursor {
+    const unsigned char *pos;
+    const unsigned char *end;
+    bool ok;
+
+    cache_cursor(const std::string& data);
+    unsigned varint();
+    std::string string();
+};
+
+#endif
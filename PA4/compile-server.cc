@@ -0,0 +1,86 @@
+//
+// compile-server.cc
+//
+// Message encoding for the compile server protocol (compile-server.h).
+//
+
+#include <errno.h>
+#include <unistd.h>
+#include "compile-server.h"
+#include "compile-cache.h"
+
+std::string encode_request(const std::vector<server_file>& files)
+{
+    std::string data;
+    cache_put_varint(data, files.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        cache_put_string(data, files[i].name.data(), files[i].name.size());
+        cache_put_string(data, files[i].source.data(), files[i].source.size());
+    }
+    return data;
+}
+
+bool decode_request(const std::string& data, std::vector<server_file>& files)
+{
+    cache_cursor in(data);
+    unsigned count = in.varint();
+    files.clear();
+    for (unsigned i = 0; i < count && in.ok; i++) {
+        server_file f;
+        f.name = in.string();
+        f.source = in.string();
+        files.push_back(f);
+    }
+    return in.ok && in.pos == in.end;
+}
+
+std::string encode_response(const server_response& response)
+{
+    std::string data;
+    cache_put_varint(data, response.status);
+    cache_put_string(data, response.output.data(), response.output.size());
+    cache_put_string(data, response.errors.data(), response.errors.size());
+    return data;
+}
+
+bool decode_response(const std::string& data, server_response& response)
+{
+    cache_cursor in(data);
+    response.status = in.varint();
+    response.output = in.string();
+    response.errors = in.string();
+    return in.ok && in.pos == in.end;
+}
+
+bool read_all(int fd, std::string& data)
+{
+    char buf[65536];
+    data.clear();
+    for (;;) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n == 0)
+            return true;
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data.append(buf, n);
+    }
+}
+
+bool write_all(int fd, const std::string& data)
+{
+    const char *p = data.data();
+    size_t left = data.size();
+    while (left > 0) {
+        ssize_t n = write(fd, p, left);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        left -= n;
+    }
+    return true;
+}
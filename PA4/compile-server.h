@@ -0,0 +1,42 @@
+#ifndef COMPILE_SERVER_H
+#define COMPILE_SERVER_H
+//
+// compile-server.h
+//
+// The protocol between coolc-server and its clients. A client connects to
+// the server's Unix socket, writes one request and shuts down its side of
+// the connection; the server answers with one response and closes it.
+//
+//    request       file count, then per file its name and source text
+//    response      status (0 = compiled, 1 = errors), the typed AST as
+//                  the semant phase prints it, and the error messages
+//
+// Counts and lengths are varints (see compile-cache.h).
+//
+
+#include <string>
+#include <vector>
+
+#define COMPILE_SERVER_SOCKET "/tmp/coolc-server.sock"
+
+struct server_file {
+    std::string name;
+    std::string source;
+};
+
+struct server_response {
+    int status;
+    std::string output;
+    std::string errors;
+};
+
+std::string encode_request(const std::vector<server_file>& files);
+bool decode_request(const std::string& data, std::vector<server_file>& files);
+std::string encode_response(const server_response& response);
+bool decode_response(const std::string& data, server_response& response);
+
+// Reads fd to end of file, and writes all of data to fd.
+bool read_all(int fd, std::string& data);
+bool write_all(int fd, const std::string& data);
+
+#endif
@@ -14,20 +14,27 @@
 #include <map>
 #include <utility> // For std::pair
 #include <vector>
+#include <string>
 #include <symtab.h>
 
 class ClassTable; // Defined in semant.h
+template <class T> class scoped_symbol_map; // Defined in semant.h
+class expr_checker; // Defined in semant.h
 
-// Environment struct <O, M, C> used in type checking
+// Environment struct <O, M, C> used in type checking, passed by reference
+// and reused from one class to the next
 struct type_env_t {
     // Object map O<id name, id type>
-    SymbolTable<Symbol, Symbol> *om;
+    scoped_symbol_map<Symbol> *om;
     // Contains the class map and inheritance graph
     // These are used for class and method inheritance
     // See semant.h for more details
     ClassTable *ct;
     // Current class C
     Class_ curr;
+    // Checks expressions in this environment; its stacks are kept from one
+    // expression to the next
+    expr_checker *checker;
 };
 
 // define the class for phylum
@@ -52,12 +59,14 @@ class Class__class : public tree_node {
 public:
    tree_node *copy()		 { return copy_Class_(); }
    virtual Class_ copy_Class_() = 0;
-    virtual Class_ type_check(type_env_t env) = 0;
-    virtual void init_class(type_env_t env) = 0;
+    virtual Class_ type_check(type_env_t& env) = 0;
+    virtual void init_class(type_env_t& env) = 0;
     virtual Symbol get_name() = 0;
     virtual Symbol get_parent() = 0;
+    virtual Features get_features() = 0;
     virtual Formals get_formals(Symbol method) = 0;
     virtual Symbol get_return_type(Symbol method) = 0;
+    virtual std::string get_interface() = 0;
 
 #ifdef Class__EXTRAS
    Class__EXTRAS
@@ -72,12 +81,14 @@ class Feature_class : public tree_node {
 public:
    tree_node *copy()		 { return copy_Feature(); }
    virtual Feature copy_Feature() = 0;
-    virtual Feature type_check(type_env_t env) = 0;
-    virtual void add_to_environment(type_env_t env) = 0;
+    virtual Feature type_check(type_env_t& env) = 0;
+    virtual void add_to_environment(type_env_t& env) = 0;
     virtual bool is_method() = 0;
     virtual Formals get_formals() = 0;
     virtual Symbol get_return_type() = 0;
     virtual Symbol get_name() = 0;
+    virtual Symbol get_type() = 0;
+    virtual void add_to_interface(std::string& interface) = 0;
 
 #ifdef Feature_EXTRAS
    Feature_EXTRAS
@@ -92,7 +103,7 @@ class Formal_class : public tree_node {
 public:
    tree_node *copy()		 { return copy_Formal(); }
    virtual Formal copy_Formal() = 0;
-    virtual Formal type_check(type_env_t env) = 0;
+    virtual Formal type_check(type_env_t& env) = 0;
     virtual Symbol get_type() = 0;
 
 #ifdef Formal_EXTRAS
@@ -108,7 +119,7 @@ class Expression_class : public tree_node {
 public:
    tree_node *copy()		 { return copy_Expression(); }
    virtual Expression copy_Expression() = 0;
-    virtual Expression type_check(type_env_t env) = 0;
+    Expression type_check(type_env_t& env);
 
 #ifdef Expression_EXTRAS
    Expression_EXTRAS
@@ -123,7 +134,6 @@ class Case_class : public tree_node {
 public:
    tree_node *copy()		 { return copy_Case(); }
    virtual Case copy_Case() = 0;
-    virtual Symbol type_check(type_env_t env) = 0;
     virtual Symbol get_type() = 0;
 
 #ifdef Case_EXTRAS
@@ -169,6 +179,9 @@ public:
    }
    Program copy_Program();
    void dump(ostream& stream, int n);
+    Classes get_classes() { return classes; }
+    void check_classes(ClassTable *classtable, SemantCache *cache, int threads);
+    void check_classes_parallel(ClassTable *classtable, int threads);
 
 #ifdef Program_SHARED_EXTRAS
    Program_SHARED_EXTRAS
@@ -195,12 +208,14 @@ public:
    }
    Class_ copy_Class_();
    void dump(ostream& stream, int n);
-    Class_ type_check(type_env_t env);
-    void init_class(type_env_t env);
+    Class_ type_check(type_env_t& env);
+    void init_class(type_env_t& env);
     Symbol get_name();
     Symbol get_parent();
+    Features get_features();
     Formals get_formals(Symbol method);
     Symbol get_return_type(Symbol method);
+    std::string get_interface();
 
 #ifdef Class__SHARED_EXTRAS
    Class__SHARED_EXTRAS
@@ -227,12 +242,14 @@ public:
    }
    Feature copy_Feature();
    void dump(ostream& stream, int n);
-    Feature type_check(type_env_t env);
-    void add_to_environment(type_env_t env);
+    Feature type_check(type_env_t& env);
+    void add_to_environment(type_env_t& env);
     bool is_method();
     Formals get_formals();
     Symbol get_return_type();
     Symbol get_name();
+    Symbol get_type();
+    void add_to_interface(std::string& interface);
 
 #ifdef Feature_SHARED_EXTRAS
    Feature_SHARED_EXTRAS
@@ -257,12 +274,14 @@ public:
    }
    Feature copy_Feature();
    void dump(ostream& stream, int n);
-    Feature type_check(type_env_t env);
-    void add_to_environment(type_env_t env);
+    Feature type_check(type_env_t& env);
+    void add_to_environment(type_env_t& env);
     bool is_method();
     Formals get_formals();
     Symbol get_return_type();
     Symbol get_name();
+    Symbol get_type();
+    void add_to_interface(std::string& interface);
 #ifdef Feature_SHARED_EXTRAS
    Feature_SHARED_EXTRAS
 #endif
@@ -284,7 +303,7 @@ public:
    }
    Formal copy_Formal();
    void dump(ostream& stream, int n);
-    Formal type_check(type_env_t env);
+    Formal type_check(type_env_t& env);
     Symbol get_type();
 
 #ifdef Formal_SHARED_EXTRAS
@@ -310,7 +329,6 @@ public:
    }
    Case copy_Case();
    void dump(ostream& stream, int n);
-    Symbol type_check(type_env_t env);
     Symbol get_type();
 
 #ifdef Case_SHARED_EXTRAS
@@ -334,7 +352,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -361,7 +378,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -386,7 +402,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -411,7 +426,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -434,7 +448,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -457,7 +470,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -478,7 +490,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -505,7 +516,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -528,7 +538,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -551,7 +560,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -574,7 +582,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -597,7 +604,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -618,7 +624,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -641,7 +646,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -664,7 +668,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -687,7 +690,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -708,7 +710,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -729,7 +730,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -750,7 +750,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -771,7 +770,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -792,7 +790,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -813,7 +810,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -832,7 +828,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -853,7 +848,6 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-    Expression type_check(type_env_t env);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -0,0 +1,184 @@
+/*
+ * coolc-client.cc
+ *          Test client for coolc-server.
+ *
+ *      coolc-client [-S socket] [-t] [-n count] [-C coolc-driver] file.cl ...
+ *
+ * Sends the files to the server and prints the response as the semant
+ * phase would: the typed AST on standard output, errors on standard error,
+ * and exit status 1 if there were errors. -n sends the same request count
+ * times (printing the last response), and -t writes the round-trip times
+ * to standard error as
+ *
+ *      server requests=<n> min_usec=<n> median_usec=<n> mean_usec=<n> max_usec=<n>
+ *
+ * followed by the time of each request in order, so that the first, which
+ * may find the server's caches cold, can be told from the rest. With -C,
+ * the same files are also compiled count times by running coolc-driver
+ * from scratch, with COOL_CGEN=- so that it too stops at the typed AST and
+ * without COOL_CACHE_DIR, and its times follow on a line of their own:
+ *
+ *      coolc-driver runs=<n> min_usec=<n> median_usec=<n> mean_usec=<n> max_usec=<n>
+ *
+ * See coolc-server.cc for the build line.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <iostream>
+#include <algorithm>
+#include "compile-server.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+
+static bool read_file(const char *path, std::string& data) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+        return false;
+    char buf[65536];
+    size_t n;
+    data.clear();
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        data.append(buf, n);
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+/* Sends one request and reads the response. */
+static bool round_trip(const char *socket_path, const std::string& request, std::string& reply) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+        perror(socket_path);
+        return false;
+    }
+    bool ok = write_all(fd, request) && shutdown(fd, SHUT_WR) == 0 && read_all(fd, reply);
+    close(fd);
+    return ok;
+}
+
+static long now_usec() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000L + tv.tv_usec;
+}
+
+/*
+ * Runs argv from scratch as a compile, discarding its output, and returns
+ * true if it ran.
+ */
+static bool run_driver(char **argv) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, 1);
+        dup2(null, 2);
+        setenv("COOL_CGEN", "-", 1);
+        unsetenv("COOL_CACHE_DIR");
+        execv(argv[0], argv);
+        _exit(127);
+    }
+    int status;
+    return pid > 0 && waitpid(pid, &status, 0) == pid &&
+        WIFEXITED(status) && WEXITSTATUS(status) != 127;
+}
+
+/* Writes label, then the count, min, median, mean and max of usec. */
+static void write_times(const char *label, const char *count_name, std::vector<long> usec) {
+    long total = 0;
+    for (size_t i = 0; i < usec.size(); i++)
+        total += usec[i];
+    std::sort(usec.begin(), usec.end());
+    cerr << label << " " << count_name << "=" << usec.size()
+         << " min_usec=" << usec.front()
+         << " median_usec=" << usec[usec.size() / 2]
+         << " mean_usec=" << total / (long) usec.size()
+         << " max_usec=" << usec.back() << endl;
+}
+
+int main(int argc, char *argv[]) {
+    const char *socket_path = COMPILE_SERVER_SOCKET;
+    bool timing = false;
+    int count = 1;
+    const char *driver = NULL;
+    int c;
+    while ((c = getopt(argc, argv, "S:tn:C:")) != -1) {
+        switch (c) {
+        case 'S': socket_path = optarg; break;
+        case 't': timing = true; break;
+        case 'n': count = atoi(optarg); break;
+        case 'C': driver = optarg; break;
+        default:
+            cerr << "usage: coolc-client [-S socket] [-t] [-n count] [-C coolc-driver] file.cl ..."
+                 << endl;
+            exit(1);
+        }
+    }
+
+    std::vector<server_file> files;
+    for (int i = optind; i < argc; i++) {
+        server_file f;
+        f.name = argv[i];
+        if (!read_file(argv[i], f.source)) {
+            cerr << "Could not open input file " << argv[i] << endl;
+            exit(1);
+        }
+        files.push_back(f);
+    }
+    std::string request = encode_request(files);
+
+    std::string reply;
+    std::vector<long> usec;
+    for (int i = 0; i < count; i++) {
+        long start = now_usec();
+        if (!round_trip(socket_path, request, reply))
+            exit(1);
+        usec.push_back(now_usec() - start);
+    }
+
+    server_response response;
+    if (!decode_response(reply, response)) {
+        cerr << "coolc-client: malformed response" << endl;
+        exit(1);
+    }
+    cout << response.output;
+    cerr << response.errors;
+    if (timing && count > 0) {
+        write_times("server", "requests", usec);
+        for (size_t i = 0; i < usec.size(); i++)
+            cerr << (i > 0 ? " " : "") << usec[i];
+        cerr << endl;
+    }
+
+    if (driver != NULL && count > 0) {
+        std::vector<char *> driver_argv;
+        driver_argv.push_back((char *) driver);
+        for (int i = optind; i < argc; i++)
+            driver_argv.push_back(argv[i]);
+        driver_argv.push_back(NULL);
+        std::vector<long> cold;
+        for (int i = 0; i < count; i++) {
+            long start = now_usec();
+            if (!run_driver(&driver_argv[0])) {
+                cerr << "coolc-client: could not run " << driver << endl;
+                exit(1);
+            }
+            cold.push_back(now_usec() - start);
+        }
+        write_times("coolc-driver", "runs", cold);
+    }
+    return response.status;
+}
@@ -0,0 +1,420 @@
+/*
+ * coolc-driver.cc
+ *          Single-process COOL front end.
+ *
+ * mycoolc runs lexer | parser | semant | cgen, and every pipe in between
+ * turns the program back into text that the next phase has to re-lex and
+ * re-intern. This driver links the lexer, parser and semantic analyzer into
+ * one executable and hands the in-memory AST from phase to phase:
+ *
+ *      coolc-driver [-o file.s] [flags] file.cl ...
+ *
+ * The lexer runs first over every file and buffers the tokens, so that
+ * lexing and parsing can be timed separately; the parser then pulls tokens
+ * from the buffer instead of from a token file. The typed AST goes to the
+ * code generator, which still ships only as the cgen executable, so it is
+ * written down a single pipe to cgen (or to standard output when COOL_CGEN
+ * is "-"). All arguments are passed on to cgen unchanged, as mycoolc does;
+ * -l, -p and -s also turn on lexer, parser and semant debugging here.
+ *
+ * When COOL_SEMANT_STREAM is set, cgen is started before semantic analysis
+ * and each class is written to it as soon as it has been checked (see
+ * program_class::semant_streaming); semant_usec then includes the writes
+ * to cgen, and cgen_usec is what cgen takes after semant has finished. If
+ * semant finds errors, the stream ends with a line the AST reader rejects
+ * (see semant.h), so cgen fails rather than compile the classes before the
+ * error.
+ *
+ * When COOL_CACHE_DIR is set, the token stream, the AST and the typed AST
+ * are saved in that directory (see compile-cache.h), and a compile of the
+ * same sources with the same compiler and flags starts from the latest
+ * saved stage, skipping lexing, parsing and semantic analysis as it can.
+ * A saved stage that does not decode is passed over. The time taken to
+ * load and decode the cache counts toward lex_usec.
+ *
+ * Per-phase times are written to standard error as one line, along with
+ * the stage the cache supplied (tokens, ast, typed, or miss):
+ *
+ *      lex_usec=<n> parse_usec=<n> semant_usec=<n> cgen_usec=<n> total_usec=<n> cache=<stage>
+ *
+ * Build it in this directory. The lexer and parser are compiled against
+ * this directory's cool-tree.h, and the lexer's cool_yylex is renamed so
+ * that the driver's token buffer can take its place:
+ *
+ *      CXX="g++ -g -Wall -Wno-unused -Wno-write-strings -I. \
+ *          -I/usr/class/cs143/cool/include/PA4 -I/usr/class/cs143/cool/src/PA4"
+ *      $CXX -Dcool_yylex=cool_lex_token -c ../PA2/cool-lex.cc
+ *      $CXX -c ../PA3/cool-parse.cc
+ *      $CXX coolc-driver.cc compile-cache.cc ast-binary.cc cool-lex.o \
+ *          cool-parse.o semant.o utilities.o stringtab.o tree.o \
+ *          cool-tree.o dumptype.o -lpthread -o coolc-driver
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <string>
+#include <vector>
+#include <sstream>
+#include "cool-tree.h"
+#include "cool-parse.h"
+#include "utilities.h"
+#include "compile-cache.h"
+
+//
+// Globals normally provided by the phase drivers and handle_flags.
+//
+FILE *fin;                      // the lexer reads from this file
+char *curr_filename = "<stdin>";
+int semant_debug = 0;
+char *semant_profile_file = NULL;
+
+extern int yy_flex_debug;       // lexer debugging, on by default in flex -d
+extern int cool_yydebug;        // parser debugging
+extern int curr_lineno;         // the parser's location (see cool.y)
+extern Program ast_root;        // the AST produced by the parse
+extern int omerrs;              // a count of lex and parse errors
+extern int cool_yyparse();
+extern int cool_lex_token();    // the lexer's cool_yylex, renamed
+extern void yyrestart(FILE *);
+
+extern "C" int yywrap() { return 1; }
+
+/*
+ * Tokens of all input files, in order, as the lexer returned them. file is
+ * an index into input_files so that curr_filename can follow the parser.
+ */
+struct buffered_token {
+    int token;
+    YYSTYPE value;
+    int lineno;
+    int file;
+};
+
+static std::vector<buffered_token> tokens;
+static size_t next_token = 0;
+static std::vector<const char *> input_files;
+
+/* Replaces the lexer's cool_yylex for the parser. */
+int cool_yylex()
+{
+    buffered_token& t = tokens[next_token];
+    if (t.token != 0)
+        next_token++;
+    cool_yylval = t.value;
+    curr_lineno = t.lineno;
+    curr_filename = (char *) input_files[t.file];
+    return t.token;
+}
+
+static long elapsed_usec(struct timeval &start, struct timeval &end) {
+    return (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+}
+
+/*
+ * Options are handed to cgen, so only -o needs to be told apart from the
+ * file names here: it is the one flag that takes an argument. Returns the
+ * flags that can change the output, for the cache key.
+ */
+static std::string handle_options(int argc, char *argv[]) {
+    std::string config("coolc-driver");
+    yy_flex_debug = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0) {
+            i++;
+            continue;
+        }
+        if (argv[i][0] != '-') {
+            input_files.push_back(argv[i]);
+            continue;
+        }
+        if (strcmp(argv[i], "-l") == 0)
+            yy_flex_debug = 1;
+        if (strcmp(argv[i], "-p") == 0)
+            cool_yydebug = 1;
+        if (strcmp(argv[i], "-s") == 0)
+            semant_debug = 1;
+        config += " ";
+        config += argv[i];
+    }
+    return config;
+}
+
+static void lex_files() {
+    for (size_t i = 0; i < input_files.size(); i++) {
+        fin = fopen(input_files[i], "r");
+        if (fin == NULL) {
+            cerr << "Could not open input file " << input_files[i] << endl;
+            exit(1);
+        }
+        curr_filename = (char *) input_files[i];
+        curr_lineno = 1;
+        yyrestart(fin);
+
+        buffered_token t;
+        t.file = i;
+        while ((t.token = cool_lex_token()) != 0) {
+            t.value = cool_yylval;
+            t.lineno = curr_lineno;
+            tokens.push_back(t);
+        }
+        fclose(fin);
+    }
+
+    buffered_token eof;
+    memset(&eof, 0, sizeof(eof));
+    eof.file = input_files.empty() ? 0 : input_files.size() - 1;
+    eof.lineno = curr_lineno;
+    tokens.push_back(eof);
+}
+
+/*
+ * The token stage of the cache: per token its code, line and file, then
+ * the text of its symbol or error message, or its boolean value.
+ */
+static std::string encode_tokens() {
+    std::string data;
+    cache_put_varint(data, tokens.size());
+    for (size_t i = 0; i < tokens.size(); i++) {
+        buffered_token& t = tokens[i];
+        cache_put_varint(data, t.token);
+        cache_put_varint(data, t.lineno);
+        cache_put_varint(data, t.file);
+        switch (t.token) {
+        case STR_CONST:
+        case INT_CONST:
+        case TYPEID:
+        case OBJECTID:
+            cache_put_string(data, t.value.symbol->get_string(), t.value.symbol->get_len());
+            break;
+        case BOOL_CONST:
+            cache_put_varint(data, t.value.boolean ? 1 : 0);
+            break;
+        case ERROR:
+            cache_put_string(data, t.value.error_msg, strlen(t.value.error_msg));
+            break;
+        }
+    }
+    return data;
+}
+
+static bool decode_tokens(const std::string& data) {
+    cache_cursor in(data);
+    unsigned count = in.varint();
+    tokens.clear();
+    for (unsigned i = 0; i < count && in.ok; i++) {
+        buffered_token t;
+        memset(&t, 0, sizeof(t));
+        t.token = in.varint();
+        t.lineno = in.varint();
+        t.file = in.varint();
+        if (t.file >= (int) input_files.size() && !input_files.empty())
+            in.ok = false;
+        std::string text;
+        switch (t.token) {
+        case STR_CONST:
+            text = in.string();
+            t.value.symbol = stringtable.add_string((char *) text.c_str(), text.size());
+            break;
+        case INT_CONST:
+            text = in.string();
+            t.value.symbol = inttable.add_string((char *) text.c_str(), text.size());
+            break;
+        case TYPEID:
+        case OBJECTID:
+            text = in.string();
+            t.value.symbol = idtable.add_string((char *) text.c_str(), text.size());
+            break;
+        case BOOL_CONST:
+            t.value.boolean = in.varint() != 0;
+            break;
+        case ERROR:
+            text = in.string();
+            t.value.error_msg = strdup(text.c_str());
+            break;
+        }
+        tokens.push_back(t);
+    }
+    if (!in.ok || tokens.empty() || tokens.back().token != 0) {
+        tokens.clear();
+        return false;
+    }
+    return true;
+}
+
+static std::string encode_ast() {
+    ast_writer writer;
+    ast_root->dump_binary(writer);
+    std::ostringstream out;
+    writer.finish(out);
+    return out.str();
+}
+
+/* Returns false, leaving ast_root alone, if data is not a binary AST. */
+static bool decode_ast(const std::string& data) {
+    ast_reader reader(data.data(), data.size());
+    Program root = reader.read();
+    if (root == NULL)
+        return false;
+    ast_root = root;
+    return true;
+}
+
+/*
+ * The pipe to cgen's standard input, or our own standard output when
+ * COOL_CGEN is "-". out buffers what is written to it and writes it down
+ * the pipe as the buffer fills, so cgen can read the typed AST while it is
+ * still being produced.
+ */
+class cgen_pipe : public std::streambuf {
+private:
+    int fd;
+    pid_t pid;                  // 0 when writing to standard output
+    char buffer[8192];
+
+    bool write_all(const char *p, size_t left) {
+        while (left > 0) {
+            ssize_t n = write(fd, p, left);
+            if (n <= 0)
+                return false;
+            p += n;
+            left -= n;
+        }
+        return true;
+    }
+
+protected:
+    int overflow(int c) {
+        if (sync() != 0)
+            return EOF;
+        if (c != EOF) {
+            *pptr() = c;
+            pbump(1);
+        }
+        return c == EOF ? 0 : c;
+    }
+    int sync() {
+        bool ok = write_all(pbase(), pptr() - pbase());
+        setp(buffer, buffer + sizeof(buffer));
+        return ok ? 0 : -1;
+    }
+
+public:
+    ostream out;
+
+    cgen_pipe() : fd(-1), pid(0), out(this) { setp(buffer, buffer + sizeof(buffer)); }
+
+    /* Starts cgen with our arguments. Returns false if it can't be run. */
+    bool start(char *argv[]) {
+        const char *cgen = getenv("COOL_CGEN");
+        if (cgen == NULL)
+            cgen = "./cgen";
+        if (strcmp(cgen, "-") == 0) {
+            fd = 1;
+            return true;
+        }
+
+        int fds[2];
+        if (pipe(fds) != 0) {
+            perror("pipe");
+            return false;
+        }
+        pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return false;
+        }
+        if (pid == 0) {
+            dup2(fds[0], 0);
+            close(fds[0]);
+            close(fds[1]);
+            argv[0] = (char *) cgen;
+            execvp(cgen, argv);
+            perror(cgen);
+            _exit(127);
+        }
+        close(fds[0]);
+        fd = fds[1];
+        return true;
+    }
+
+    /* Closes the pipe and waits for cgen. Returns its exit status. */
+    int finish() {
+        out.flush();
+        if (pid == 0)
+            return 0;
+        close(fd);
+        int status;
+        if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status))
+            return 1;
+        return WEXITSTATUS(status);
+    }
+};
+
+int main(int argc, char *argv[]) {
+    struct timeval start, lexed, parsed, analyzed, generated;
+    std::string config = handle_options(argc, argv);
+
+    gettimeofday(&start, NULL);
+    compile_cache cache;
+    cache.open(getenv("COOL_CACHE_DIR"), config, input_files);
+    cache_stage hit = CACHE_STAGES;
+    std::string data;
+    if (cache.load(CACHE_TYPED, data) && decode_ast(data))
+        hit = CACHE_TYPED;
+    else if (cache.load(CACHE_AST, data) && decode_ast(data))
+        hit = CACHE_AST;
+    else if (cache.load(CACHE_TOKENS, data) && decode_tokens(data))
+        hit = CACHE_TOKENS;
+    cache.record(hit);
+
+    if (hit == CACHE_STAGES) {
+        lex_files();
+        cache.store(CACHE_TOKENS, encode_tokens());
+    }
+    gettimeofday(&lexed, NULL);
+
+    if (hit == CACHE_STAGES || hit == CACHE_TOKENS) {
+        cool_yyparse();
+        if (omerrs != 0) {
+            cerr << "Compilation halted due to lex and parse errors\n";
+            exit(1);
+        }
+        cache.store(CACHE_AST, encode_ast());
+    }
+    gettimeofday(&parsed, NULL);
+
+    cgen_pipe cgen;
+    int status = 1;
+    if (hit != CACHE_TYPED && getenv("COOL_SEMANT_STREAM") != NULL) {
+        // cgen starts on each class as soon as semant has checked it.
+        if (cgen.start(argv)) {
+            ast_root->semant_streaming(cgen.out);   // exits on semantic errors
+            cache.store(CACHE_TYPED, encode_ast());
+            gettimeofday(&analyzed, NULL);
+            status = cgen.finish();
+        } else
+            gettimeofday(&analyzed, NULL);
+    } else {
+        if (hit != CACHE_TYPED) {
+            ast_root->semant();     // exits on semantic errors
+            cache.store(CACHE_TYPED, encode_ast());
+        }
+        gettimeofday(&analyzed, NULL);
+        if (cgen.start(argv)) {
+            ast_root->dump_with_types(cgen.out, 0);
+            status = cgen.finish();
+        }
+    }
+    gettimeofday(&generated, NULL);
+
+    cerr << "lex_usec=" << elapsed_usec(start, lexed)
+         << " parse_usec=" << elapsed_usec(lexed, parsed)
+         << " semant_usec=" << elapsed_usec(parsed, analyzed)
+         << " cgen_usec=" << elapsed_usec(analyzed, generated)
+         << " total_usec=" << elapsed_usec(start, generated)
+         << " cache=" << cache_stage_name(hit) << endl;
+    return status;
+}
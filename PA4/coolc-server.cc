@@ -0,0 +1,303 @@
+/*
+ * coolc-server.cc
+ *          Compile server for many small compilations.
+ *
+ * Most of the time of a one-file compile goes to starting the phases:
+ * interning the predefined symbols, building the basic classes and loading
+ * the lexer, parser and semant. The server does that once and then serves
+ * compiles over a Unix socket (protocol in compile-server.h):
+ *
+ *      coolc-server [-i] [socket]      default /tmp/coolc-server.sock
+ *      coolc-client [-S socket] [-t] [-n count] [-C coolc-driver] file.cl ...
+ *
+ * At startup the server compiles a small built-in program, which interns
+ * the symbols and builds the basic classes. Each request is then handled
+ * in a process forked from the server, so it starts with that state already
+ * in memory, cannot leave anything behind for the next request (the tree
+ * package never frees nodes), and cannot take the server down with it.
+ * That also means nothing a request computes outlives it: the class table
+ * of the files and any cache of their checks are built again by every
+ * request, so what the server saves over coolc-driver is only the startup
+ * (coolc-client -C measures both).
+ *
+ * With -i (incremental) the server instead handles requests itself, one at
+ * a time, and keeps a SemantCache (see semant.h) for each list of file
+ * names it is sent. Compiling the same files again after an edit then
+ * rechecks only the classes the edit could have affected. The price is
+ * that every request's AST stays in the server's memory, and that a
+ * request that crashes the compiler takes the server with it.
+ *
+ * A request gets back what the semant phase would print: the typed AST, or
+ * the lex, parse and semantic errors. The server logs each request on
+ * standard error, with the classes checked and reused under -i.
+ *
+ * Build it like coolc-driver (see coolc-driver.cc), from the same renamed
+ * lexer:
+ *
+ *      $CXX coolc-server.cc compile-server.cc compile-cache.cc cool-lex.o \
+ *          cool-parse.o semant.o utilities.o stringtab.o tree.o \
+ *          cool-tree.o dumptype.o -lpthread -o coolc-server
+ *      $CXX coolc-client.cc compile-server.cc compile-cache.cc -o coolc-client
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include "cool-tree.h"
+#include "cool-parse.h"
+#include "semant.h"
+#include "compile-server.h"
+
+//
+// Globals normally provided by the phase drivers and handle_flags.
+//
+FILE *fin;                      // the lexer reads from this file
+char *curr_filename = "<stdin>";
+int semant_debug = 0;
+char *semant_profile_file = NULL;
+
+extern int yy_flex_debug;       // lexer debugging, on by default in flex -d
+extern int cool_yydebug;        // parser debugging
+extern int curr_lineno;         // the parser's location (see cool.y)
+extern Program ast_root;        // the AST produced by the parse
+extern int omerrs;              // a count of lex and parse errors
+extern int cool_yyparse();
+extern int cool_lex_token();    // the lexer's cool_yylex, renamed
+extern void yyrestart(FILE *);
+
+extern "C" int yywrap() { return 1; }
+
+static const char *warm_up_program =
+    "class Main inherits IO {\n"
+    "    main() : Object { out_string(\"hello\\n\") };\n"
+    "};\n";
+
+/*
+ * As in coolc-driver, all files of a request are lexed into one buffer
+ * that the parser reads through cool_yylex, so that each token keeps the
+ * name of the file it came from.
+ */
+struct buffered_token {
+    int token;
+    YYSTYPE value;
+    int lineno;
+    int file;
+};
+
+static std::vector<buffered_token> tokens;
+static size_t next_token = 0;
+static std::vector<char *> file_names;
+
+/* Replaces the lexer's cool_yylex for the parser. */
+int cool_yylex()
+{
+    buffered_token& t = tokens[next_token];
+    if (t.token != 0)
+        next_token++;
+    cool_yylval = t.value;
+    curr_lineno = t.lineno;
+    curr_filename = file_names[t.file];
+    return t.token;
+}
+
+static void lex_files(const std::vector<server_file>& files) {
+    tokens.clear();
+    next_token = 0;
+    file_names.clear();
+    for (size_t i = 0; i < files.size(); i++) {
+        file_names.push_back(strdup(files[i].name.c_str()));
+        curr_filename = file_names[i];
+        curr_lineno = 1;
+        if (files[i].source.empty())
+            continue;
+        fin = fmemopen((void *) files[i].source.data(), files[i].source.size(), "r");
+        yyrestart(fin);
+
+        buffered_token t;
+        t.file = i;
+        while ((t.token = cool_lex_token()) != 0) {
+            t.value = cool_yylval;
+            t.lineno = curr_lineno;
+            tokens.push_back(t);
+        }
+        fclose(fin);
+    }
+    if (file_names.empty())
+        file_names.push_back(curr_filename);
+
+    buffered_token eof;
+    memset(&eof, 0, sizeof(eof));
+    eof.file = file_names.size() - 1;
+    eof.lineno = curr_lineno;
+    tokens.push_back(eof);
+}
+
+/*
+ * Runs the front end over files, with cache if not NULL. Lex and parse
+ * errors go to cerr, so cerr is pointed at the response for the duration.
+ */
+static server_response compile(const std::vector<server_file>& files, SemantCache *cache) {
+    server_response response;
+    std::ostringstream output, errors;
+    std::streambuf *saved = cerr.rdbuf(errors.rdbuf());
+
+    response.status = 1;
+    lex_files(files);
+    omerrs = 0;
+    cool_yyparse();
+    if (omerrs != 0) {
+        cerr << "Compilation halted due to lex and parse errors\n";
+    } else if (ast_root->semant(errors, cache) != 0) {
+        cerr << "Compilation halted due to static semantic errors." << endl;
+    } else {
+        ast_root->dump_with_types(output, 0);
+        response.status = 0;
+    }
+
+    cerr.rdbuf(saved);
+    response.output = output.str();
+    response.errors = errors.str();
+    return response;
+}
+
+static void warm_up() {
+    std::vector<server_file> files(1);
+    files[0].name = "<warm-up>";
+    files[0].source = warm_up_program;
+    server_response response = compile(files, NULL);
+    if (response.status != 0) {
+        cerr << response.errors;
+        exit(1);
+    }
+}
+
+static long elapsed_usec(struct timeval &start, struct timeval &end) {
+    return (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+}
+
+/*
+ * Under -i, the cache for each list of file names, by the names joined
+ * with newlines.
+ */
+static bool incremental = false;
+static std::map<std::string, SemantCache *> caches;
+
+static SemantCache *cache_for(const std::vector<server_file>& files) {
+    std::string key;
+    for (size_t i = 0; i < files.size(); i++)
+        key += files[i].name + "\n";
+    SemantCache *&cache = caches[key];
+    if (cache == NULL)
+        cache = new SemantCache;
+    return cache;
+}
+
+/*
+ * Handles one connection: in the forked child, or in the server itself
+ * under -i. The request is logged before the connection is closed, so a
+ * client that has its response can find it in the log.
+ */
+static void serve(int conn) {
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+
+    std::string request;
+    std::vector<server_file> files;
+    server_response response;
+    SemantCache *cache = NULL;
+    if (!read_all(conn, request) || !decode_request(request, files)) {
+        response.status = 1;
+        response.errors = "coolc-server: malformed request\n";
+    } else {
+        if (incremental)
+            cache = cache_for(files);
+        response = compile(files, cache);
+    }
+    write_all(conn, encode_response(response));
+
+    gettimeofday(&end, NULL);
+    cerr << "coolc-server: " << files.size() << " file(s), status " << response.status
+         << ", " << elapsed_usec(start, end) << " usec";
+    if (cache != NULL)
+        cerr << ", " << cache->checked << " checked, " << cache->reused << " reused";
+    cerr << endl;
+    close(conn);
+}
+
+static const char *socket_path;
+
+static void remove_socket(int sig) {
+    unlink(socket_path);
+    _exit(0);
+}
+
+int main(int argc, char *argv[]) {
+    int c;
+    while ((c = getopt(argc, argv, "i")) != -1) {
+        switch (c) {
+        case 'i': incremental = true; break;
+        default:
+            cerr << "usage: coolc-server [-i] [socket]" << endl;
+            exit(1);
+        }
+    }
+    socket_path = optind < argc ? argv[optind] : COMPILE_SERVER_SOCKET;
+    yy_flex_debug = 0;
+    warm_up();
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        cerr << "coolc-server: socket path too long: " << socket_path << endl;
+        exit(1);
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socket_path);
+    if (listener < 0 || bind(listener, (struct sockaddr *) &addr, sizeof(addr)) != 0 ||
+        listen(listener, 64) != 0) {
+        perror(socket_path);
+        exit(1);
+    }
+    signal(SIGCHLD, SIG_IGN);           // children are never waited for
+    signal(SIGINT, remove_socket);
+    signal(SIGTERM, remove_socket);
+    cerr << "coolc-server: listening on " << socket_path
+         << (incremental ? " (incremental)" : "") << endl;
+
+    for (;;) {
+        int conn = accept(listener, NULL, NULL);
+        if (conn < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("accept");
+            break;
+        }
+        if (incremental) {
+            serve(conn);
+            continue;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(listener);
+            serve(conn);
+            _exit(0);
+        }
+        if (pid < 0)
+            perror("fork");
+        close(conn);
+    }
+    unlink(socket_path);
+    return 1;
+}
@@ -1 +0,0 @@
-/usr/class/cs143/cool/src/PA4/dumptype.cc
\ No newline at end of file
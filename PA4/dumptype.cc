@@ -0,0 +1,120 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+// This is the course's dumptype.cc, writing the same text, with
+// dump_with_types rewritten over ast_walk (ast-binary.h) so that it keeps
+// its own stack rather than recurse once per level of nesting. The parser
+// (PA3/dumptype.cc) includes this file.
+//
+#include "copyright.h"
+
+#include <stdio.h>
+#include "cool-tree.h"
+#include "utilities.h"
+
+//
+// Each node is written as its line number and constructor name, then its
+// fields indented two more spaces; an expression ends with its type.
+//
+
+static const char *const constructor_names[] = {
+    NULL,
+    "_program", "_class", "_method", "_attr", "_formal", "_branch",
+    "_assign", "_static_dispatch", "_dispatch", "_cond", "_loop",
+    "_typcase", "_block", "_let", "_plus", "_sub", "_mul", "_divide",
+    "_neg", "_lt", "_eq", "_leq", "_comp", "_int", "_bool", "_string",
+    "_new", "_isvoid", "_no_expr", "_object"
+};
+
+static void dump_string(ostream& stream, int n, Symbol s)
+{
+    stream << pad(n) << "\"";
+    print_escaped_string(stream, s->get_string());
+    stream << "\"\n";
+}
+
+/*
+ * ast_walk visitor that writes dump_with_types text. A class's filename
+ * comes before its features, and only the features of a class and the
+ * actuals of a dispatch are parenthesized.
+ */
+class typed_dumper {
+private:
+    ostream& stream;
+
+    static bool parenthesized(ast_tag owner)
+        { return owner == AST_CLASS || owner == AST_DISPATCH || owner == AST_STATIC_DISPATCH; }
+
+public:
+    typed_dumper(ostream& s) : stream(s) { }
+
+    void node(ast_tag tag, tree_node *t, int n) {
+        stream << pad(n) << "#" << t->get_line_number() << "\n";
+        stream << pad(n) << constructor_names[tag] << "\n";
+    }
+    void symbol(ast_tag owner, Symbol s, int table, int n) {
+        if (table != AST_STRING_TABLE)
+            dump_Symbol(stream, n, s);
+        else if (owner != AST_CLASS)
+            dump_string(stream, n, s);
+    }
+    void boolean(ast_tag, bool b, int n) { dump_Boolean(stream, n, b); }
+    void list(ast_tag owner, tree_node *t, int, int n) {
+        if (owner == AST_CLASS)
+            dump_string(stream, n, static_cast<Class_>(t)->get_filename());
+        if (parenthesized(owner))
+            stream << pad(n) << "(\n";
+    }
+    void end_list(ast_tag owner, tree_node *, int n) {
+        if (parenthesized(owner))
+            stream << pad(n) << ")\n";
+    }
+    void type(tree_node *t, Symbol, int n) { static_cast<Expression>(t)->dump_type(stream, n); }
+};
+
+void Expression_class::dump_type(ostream& stream, int n)
+{
+    if (type)
+        stream << pad(n) << ": " << type << endl;
+    else
+        stream << pad(n) << ": _no_type" << endl;
+}
+
+#define DUMP_WITH_TYPES(constructor)                                    \
+void constructor::dump_with_types(ostream& stream, int n)               \
+{                                                                       \
+    typed_dumper d(stream);                                             \
+    ast_walk(this, d, n);                                               \
+}
+
+DUMP_WITH_TYPES(program_class)
+DUMP_WITH_TYPES(class__class)
+DUMP_WITH_TYPES(method_class)
+DUMP_WITH_TYPES(attr_class)
+DUMP_WITH_TYPES(formal_class)
+DUMP_WITH_TYPES(branch_class)
+DUMP_WITH_TYPES(assign_class)
+DUMP_WITH_TYPES(static_dispatch_class)
+DUMP_WITH_TYPES(dispatch_class)
+DUMP_WITH_TYPES(cond_class)
+DUMP_WITH_TYPES(loop_class)
+DUMP_WITH_TYPES(typcase_class)
+DUMP_WITH_TYPES(block_class)
+DUMP_WITH_TYPES(let_class)
+DUMP_WITH_TYPES(plus_class)
+DUMP_WITH_TYPES(sub_class)
+DUMP_WITH_TYPES(mul_class)
+DUMP_WITH_TYPES(divide_class)
+DUMP_WITH_TYPES(neg_class)
+DUMP_WITH_TYPES(lt_class)
+DUMP_WITH_TYPES(eq_class)
+DUMP_WITH_TYPES(leq_class)
+DUMP_WITH_TYPES(comp_class)
+DUMP_WITH_TYPES(int_const_class)
+DUMP_WITH_TYPES(bool_const_class)
+DUMP_WITH_TYPES(string_const_class)
+DUMP_WITH_TYPES(new__class)
+DUMP_WITH_TYPES(isvoid_class)
+DUMP_WITH_TYPES(no_expr_class)
+DUMP_WITH_TYPES(object_class)
@@ -0,0 +1,18 @@
+-- After: C inherits B instead, which changes the class hierarchy, so every
+-- class is rechecked, not only C and the classes that look at C.
+-- incremental: 4 checked, 0 reused
+class A {
+    a : Int;
+};
+
+class B inherits A {
+    b : Int;
+};
+
+class C inherits B {
+    c : Int;
+};
+
+class Main {
+    main() : Object { let x : A <- new C in x };
+};
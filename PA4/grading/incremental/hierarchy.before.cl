@@ -0,0 +1,16 @@
+-- Before: C inherits A.
+class A {
+    a : Int;
+};
+
+class B inherits A {
+    b : Int;
+};
+
+class C inherits A {
+    c : Int;
+};
+
+class Main {
+    main() : Object { let x : A <- new C in x };
+};
@@ -0,0 +1,19 @@
+-- After: the classes move down, so the errors reused from the last run
+-- must be reported at the new lines.
+-- incremental: 0 checked, 3 reused
+
+
+class A {
+    f(y : Int) : Int { y };
+};
+
+
+class B inherits A {
+    g() : Int { f("two") };
+};
+
+
+
+class Main {
+    main() : Object { undefined };
+};
@@ -0,0 +1,12 @@
+-- Before: B.g and Main.main have errors, reported at their lines.
+class A {
+    f(y : Int) : Int { y };
+};
+
+class B inherits A {
+    g() : Int { f("two") };
+};
+
+class Main {
+    main() : Object { undefined };
+};
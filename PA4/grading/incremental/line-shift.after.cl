@@ -0,0 +1,18 @@
+-- After: only comments are added, above and between the classes, so every
+-- class is reused, but the typed AST must carry the new line numbers.
+-- incremental: 0 checked, 3 reused
+
+class A inherits IO {
+    x : Int <- 1;
+    f(y : Int) : Int { x + y };
+};
+
+-- B moves down by three lines more.
+
+class B inherits A {
+    g() : Object { out_int(f(2)) };
+};
+
+class Main {
+    main() : Object { (new B).g() };
+};
@@ -0,0 +1,13 @@
+-- Before: the classes start at line 2.
+class A inherits IO {
+    x : Int <- 1;
+    f(y : Int) : Int { x + y };
+};
+
+class B inherits A {
+    g() : Object { out_int(f(2)) };
+};
+
+class Main {
+    main() : Object { (new B).g() };
+};
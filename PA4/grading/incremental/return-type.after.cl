@@ -0,0 +1,18 @@
+-- After: A.f returns String, so B.g, which calls it and was not edited,
+-- must be rechecked and now has an error. C and Main do not call A.f.
+-- incremental: 2 checked, 2 reused
+class A {
+    f() : String { "one" };
+};
+
+class B {
+    g(a : A) : Int { a.f() + 1 };
+};
+
+class C {
+    h() : Int { 2 };
+};
+
+class Main {
+    main() : Object { (new B).g(new A) };
+};
@@ -0,0 +1,16 @@
+-- Before: A.f returns Int, which B.g adds to.
+class A {
+    f() : Int { 1 };
+};
+
+class B {
+    g(a : A) : Int { a.f() + 1 };
+};
+
+class C {
+    h() : Int { 2 };
+};
+
+class Main {
+    main() : Object { (new B).g(new A) };
+};
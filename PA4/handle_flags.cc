@@ -0,0 +1,126 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+// This is the course's handle_flags.cc with a few additions:
+//   -P <file>      semant writes a profile of its phases as JSON to <file>,
+//                  or to standard error if <file> is "-" (see semant.h)
+//   -b <manifest>  semant checks the programs listed in <manifest>
+//                  (see semant-phase.cc)
+//   -j <threads>   the number of threads checking them
+//
+#include "copyright.h"
+
+#include <unistd.h>
+#include <stdlib.h>
+#include "cool-io.h"
+#include "cgen_gc.h"
+
+extern int optind;            // used for option processing (man 3 getopt for more info)
+
+int yy_flex_debug;            // for the lexer; prints recognized rules
+extern int cool_yydebug;      // for the parser
+int lex_verbose;              // controls printing of tokens
+int semant_debug;             // for semantic analysis
+int cgen_debug;               // for code gen
+bool disable_reg_alloc;       // Don't do register allocation
+bool cgen_optimize;           // optimize the generated code
+char *out_filename;           // file name for generated code
+char *semant_profile_file;    // where semant writes its profile, if anywhere
+char *batch_manifest;         // the programs semant checks in batch mode
+int batch_threads;            // threads for batch mode, 0 for one per CPU
+Memmgr cgen_Memmgr = GC_NOGC;             // enable/disable garbage collection
+Memmgr_Test cgen_Memmgr_Test = GC_NORMAL; // normal/test GC
+Memmgr_Debug cgen_Memmgr_Debug = GC_QUICK; // check heap frequently
+
+void handle_flags(int argc, char *argv[]) {
+  int c;
+  int unknownopt = 0;
+
+  // no debugging or GC by default
+  yy_flex_debug = 0;
+  cool_yydebug = 0;
+  lex_verbose  = 0;
+  semant_debug = 0;
+  cgen_debug = 0;
+  cgen_optimize = false;
+  disable_reg_alloc = false;
+  semant_profile_file = NULL;
+  batch_manifest = NULL;
+  batch_threads = 0;
+
+  while ((c = getopt(argc, argv, "lpscvrgtTOo:P:b:j:")) != -1) {
+    switch (c) {
+#ifdef DEBUG
+    case 'l':
+      yy_flex_debug = 1;
+      break;
+    case 'p':
+      cool_yydebug = 1;
+      break;
+    case 's':
+      semant_debug = 1;
+      break;
+    case 'c':
+      cgen_debug = 1;
+      break;
+    case 'v':
+      lex_verbose = 1;
+      break;
+    case 'r':
+      disable_reg_alloc = true;
+      break;
+#else
+    case 'l':
+    case 'p':
+    case 's':
+    case 'c':
+    case 'v':
+    case 'r':
+      cerr << "No debugging available\n";
+      break;
+#endif
+    case 'g':  // enable garbage collection
+      cgen_Memmgr = GC_GENGC;
+      break;
+    case 't':  // run garbage collection very frequently (on every allocation)
+      cgen_Memmgr_Test = GC_TEST;
+      break;
+    case 'T':  // do paranoid heap checks
+      cgen_Memmgr_Debug = GC_DEBUG;
+      break;
+    case 'o':  // set the name of the output file
+      out_filename = optarg;
+      break;
+    case 'O':  // enable optimization
+      cgen_optimize = true;
+      break;
+    case 'P':  // profile semantic analysis
+      semant_profile_file = optarg;
+      break;
+    case 'b':  // check the programs of a manifest
+      batch_manifest = optarg;
+      break;
+    case 'j':  // threads checking them
+      batch_threads = atoi(optarg);
+      break;
+    case '?':
+      unknownopt = 1;
+      break;
+    case ':':
+      unknownopt = 1;
+      break;
+    }
+  }
+
+  if (unknownopt) {
+    cerr << "usage: " << argv[0] <<
+#ifdef DEBUG
+    " [-lvpscOgtTr -o outname -P profile -b manifest -j threads] [input-files]\n";
+#else
+    " [-OgtT -o outname -P profile -b manifest -j threads] [input-files]\n";
+#endif
+    exit(1);
+  }
+
+}
@@ -0,0 +1,63 @@
+/*
+ * image-outline-phase.cc
+ *          Lists the classes and features of an AST image.
+ *
+ * Maps an AST image (see ast-image.h) from standard input and prints one
+ * line per class and per feature, e.g.
+ *
+ *      class Main inherits IO (main.cl:1)
+ *        method main(x : Int) : Object
+ *        attr count : Int
+ *
+ * It reads the records in place through ast_node_view; no tree nodes are
+ * built and no symbols are interned, so the cost is the mapping and the
+ * records it touches. Build it with
+ *
+ *      g++ -g -Wall -Wno-unused -Wno-write-strings -I. \
+ *          -I/usr/class/cs143/cool/include/PA4 -I/usr/class/cs143/cool/src/PA4 \
+ *          image-outline-phase.cc ast-image.cc ast-binary.cc utilities.o \
+ *          stringtab.o tree.o cool-tree.o dumptype.o -o image-outline
+ *
+ * and use it as
+ *
+ *      lexer foo.cl | binary-parser | ast-image > foo.img
+ *      image-outline < foo.img
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "cool-tree.h"
+#include "ast-image.h"
+
+static void print_feature(ast_node_view f)
+{
+    if (f.tag() == AST_ATTR) {
+        printf("  attr %s : %s\n", f.text(0), f.text(1));
+        return;
+    }
+    printf("  method %s(", f.text(0));
+    int formals = f.list_length(1);
+    for (int i = 0; i < formals; i++) {
+        ast_node_view formal = f.list_elem(1, i);
+        printf("%s%s : %s", i == 0 ? "" : ", ", formal.text(0), formal.text(1));
+    }
+    printf(") : %s\n", f.text(2));
+}
+
+int main(int argc, char *argv[]) {
+    ast_image image;
+    if (!image.open(fileno(stdin))) {
+        fprintf(stderr, "image-outline: standard input is not an AST image file\n");
+        exit(1);
+    }
+
+    ast_node_view program = image.root();
+    int classes = program.list_length(0);
+    for (int i = 0; i < classes; i++) {
+        ast_node_view c = program.list_elem(0, i);
+        printf("class %s inherits %s (%s:%d)\n", c.text(0), c.text(1), c.text(3), c.line());
+        int features = c.list_length(2);
+        for (int j = 0; j < features; j++)
+            print_feature(c.list_elem(2, j));
+    }
+    return 0;
+}
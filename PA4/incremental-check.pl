@@ -0,0 +1,136 @@
+#!/usr/bin/perl -w
+#
+# incremental-check.pl
+#
+# Checks incremental semantic analysis (SemantCache in semant.h) against
+# checking from scratch.
+#
+# Usage:
+#   incremental-check.pl [options]
+#
+# Starts coolc-server -i, which keeps a SemantCache per list of files, and
+# for every grading/incremental/<name>.before.cl sends it and then
+# <name>.after.cl under the same file name, as an edit of it. The response
+# to the edit must match what lexer | parser | semant print for the edited
+# file from scratch: standard output, standard error and exit status. An
+# edited file may say how many classes the edit should recheck and reuse,
+# in a comment line
+#
+#   -- incremental: <n> checked, <n> reused
+#
+# which must match the counts the server logs for the request. Prints one
+# line per mismatch and exits with status 1 if there were any.
+#
+
+use strict;
+
+use File::Copy;
+use File::Temp qw(tempdir);
+use Getopt::Long;
+
+my $lexer = "../PA2/lexer";
+my $parser = "../PA3/parser";
+my $semant = "./semant";
+my $server = "./coolc-server";
+my $client = "./coolc-client";
+my $case_dir = "./grading/incremental";
+my $verbose;
+
+sub usage {
+    print "Usage: $0 [options]\n";
+    print "    Options: -lexer <path>   - lexer phase [default = \"$lexer\"]\n";
+    print "             -parser <path>  - parser phase [default = \"$parser\"]\n";
+    print "             -semant <path>  - semant phase [default = \"$semant\"]\n";
+    print "             -server <path>  - compile server [default = \"$server\"]\n";
+    print "             -client <path>  - compile server client [default = \"$client\"]\n";
+    print "             -dir <path>     - directory of *.before.cl and *.after.cl [default = \"$case_dir\"]\n";
+    print "             -v              - list every case checked\n";
+    return "\n";
+}
+
+die usage()
+    unless(GetOptions("lexer=s" => \$lexer,
+		      "parser=s" => \$parser,
+		      "semant=s" => \$semant,
+		      "server=s" => \$server,
+		      "client=s" => \$client,
+		      "dir=s" => \$case_dir,
+		      "v" => \$verbose));
+
+foreach my $program ($server, $client) {
+    die "$program not found; see coolc-server.cc for how to build it\n" unless -x $program;
+}
+
+my $work_dir = tempdir("incremental-check-XXXXXX", TMPDIR => 1, CLEANUP => 1);
+my $socket = "$work_dir/server.sock";
+my $log = "$work_dir/server.log";
+
+sub slurp {
+    my ($file) = @_;
+    open(IN, "<$file") || return "";
+    local $/;
+    my $text = <IN>;
+    close(IN);
+    return defined($text) ? $text : "";
+}
+
+# Runs $cmd, as (stdout, stderr, exit status).
+sub run {
+    my ($cmd) = @_;
+    system("($cmd) > $work_dir/out 2> $work_dir/err");
+    return (slurp("$work_dir/out"), slurp("$work_dir/err"), $? >> 8);
+}
+
+my $server_pid = fork();
+die "fork: $!\n" unless defined($server_pid);
+if ($server_pid == 0) {
+    open(STDERR, ">$log") || die "Cannot write $log: $!\n";
+    exec($server, "-i", $socket) || die "Cannot run $server: $!\n";
+}
+for (my $i = 0; $i < 100 && !-S $socket; $i++) {
+    select(undef, undef, undef, 0.1);
+}
+die "$server did not start\n" unless -S $socket;
+
+my $failures = 0;
+foreach my $before (sort glob("$case_dir/*.before.cl")) {
+    my $name = $before;
+    $name =~ s/.*\///;
+    $name =~ s/\.before\.cl$//;
+    my $after = "$case_dir/$name.after.cl";
+    next unless -f $after;
+
+    # Both versions go by the same name, so the server takes the second
+    # for an edit of the first.
+    my $file = "$work_dir/$name.cl";
+    my @problems;
+    copy($before, $file) || die "Cannot write $file: $!\n";
+    run("$client -S $socket $file");
+    copy($after, $file) || die "Cannot write $file: $!\n";
+    my @edit = run("$client -S $socket $file");
+    my @scratch = run("$lexer $file | $parser | $semant");
+
+    push @problems, "exit status $edit[2], expected $scratch[2]" if $edit[2] != $scratch[2];
+    push @problems, "errors differ" if $edit[1] ne $scratch[1];
+    push @problems, "output differs" if $edit[0] ne $scratch[0];
+    if (slurp($after) =~ /^-- incremental: (\d+) checked, (\d+) reused$/m) {
+	my ($checked, $reused) = ($1, $2);
+	my @lines = split(/\n/, slurp($log));
+	if ($lines[-1] !~ /(\d+) checked, (\d+) reused$/) {
+	    push @problems, "no counts in the server log";
+	} elsif ($1 != $checked || $2 != $reused) {
+	    push @problems, "$1 checked, $2 reused, expected $checked checked, $reused reused";
+	}
+    }
+    foreach my $problem (@problems) {
+	print "$name: $problem\n";
+	$failures++;
+    }
+    print "$name: ok\n" if $verbose && !@problems;
+}
+
+kill("TERM", $server_pid);
+waitpid($server_pid, 0);
+
+print $failures ? "$failures mismatches\n" : "All edits match checking from scratch\n";
+exit($failures ? 1 : 0);
@@ -0,0 +1,247 @@
+#!/usr/bin/perl -w
+#
+# mode-check.pl
+#
+# Checks semant's optional modes against its default path.
+#
+# Usage:
+#   mode-check.pl [options]
+#
+# Runs lexer | parser | semant over every grading/*.test file, then runs
+# each input again with one mode switched on and compares standard output,
+# standard error and exit status with the default run:
+#
+#   binary     lexer | binary-parser | binary-semant, through the binary AST
+#              (ast-binary.h).
+#   image      lexer | binary-parser | ast-image into a file, then
+#              image-semant from it, through the AST image (ast-image.h).
+#   memo       COOL_SEMANT_MEMO=1, leaving out the memo: line it adds to
+#              standard error.
+#   parallel   COOL_SEMANT_THREADS=3.
+#   stream     COOL_SEMANT_STREAM=1. A program without errors must give the
+#              same output. A program with errors must give the same errors
+#              and exit status, and its output must end with the halted
+#              marker (SEMANT_STREAM_HALTED in semant.h).
+#
+# The binary and image modes must give the same results as the default
+# where the input parses; where it does not, the same lex and parse errors
+# and a failing exit status. The memo and parallel modes must give the
+# same results.
+# Modes whose programs have not been built are skipped, with a note.
+#
+# Inputs with an expected output for a mode, as grading/<name>.test.<mode>,
+# must also match it exactly.
+#
+# The binary and image modes are also run over a generated program whose
+# main is a chain of 200,000 additions, nested that deep in the AST, and
+# must check it without errors and write every addition in the typed AST.
+# (The default path cannot read it back: semant's AST parser has a fixed
+# stack.) Prints one line per mismatch and exits with status 1 if there
+# were any.
+#
+
+use strict;
+
+use File::Temp qw(tempdir);
+use Getopt::Long;
+
+my $lexer = "../PA2/lexer";
+my $parser = "../PA3/parser";
+my $semant = "./semant";
+my $binary_parser = "../PA3/binary-parser";
+my $binary_semant = "./binary-semant";
+my $ast_image = "./ast-image";
+my $image_semant = "./image-semant";
+my $grading_dir = "./grading";
+my $verbose;
+
+sub usage {
+    print "Usage: $0 [options]\n";
+    print "    Options: -lexer <path>   - lexer phase [default = \"$lexer\"]\n";
+    print "             -parser <path>  - parser phase [default = \"$parser\"]\n";
+    print "             -semant <path>  - semant phase [default = \"$semant\"]\n";
+    print "             -binary-parser <path> - binary AST parser [default = \"$binary_parser\"]\n";
+    print "             -binary-semant <path> - binary AST semant [default = \"$binary_semant\"]\n";
+    print "             -ast-image <path>     - AST image writer [default = \"$ast_image\"]\n";
+    print "             -image-semant <path>  - AST image semant [default = \"$image_semant\"]\n";
+    print "             -dir <path>     - directory of *.test inputs [default = \"$grading_dir\"]\n";
+    print "             -v              - list every input and mode checked\n";
+    return "\n";
+}
+
+die usage()
+    unless(GetOptions("lexer=s" => \$lexer,
+		      "parser=s" => \$parser,
+		      "semant=s" => \$semant,
+		      "binary-parser=s" => \$binary_parser,
+		      "binary-semant=s" => \$binary_semant,
+		      "ast-image=s" => \$ast_image,
+		      "image-semant=s" => \$image_semant,
+		      "dir=s" => \$grading_dir,
+		      "v" => \$verbose));
+
+my $work_dir = tempdir("mode-check-XXXXXX", TMPDIR => 1, CLEANUP => 1);
+my $halted = "#halted: static semantic errors\n";
+
+sub slurp {
+    my ($file) = @_;
+    open(IN, "<$file") || return "";
+    local $/;
+    my $text = <IN>;
+    close(IN);
+    return defined($text) ? $text : "";
+}
+
+# Runs $cmd with $env set, as (stdout, stderr, exit status).
+sub run {
+    my ($env, $cmd) = @_;
+    my $export = $env ne "" ? "export $env; " : "";
+    system("($export$cmd) > $work_dir/out 2> $work_dir/err");
+    return (slurp("$work_dir/out"), slurp("$work_dir/err"), $? >> 8);
+}
+
+sub semant_cmd {
+    my ($input) = @_;
+    return "$lexer $input | $parser | $semant";
+}
+
+# The problems with a mode's result that should match the default's.
+sub compare_same {
+    my ($default, $mode) = @_;
+    my @problems;
+    push @problems, "exit status $mode->[2], expected $default->[2]"
+	if $mode->[2] != $default->[2];
+    push @problems, "errors differ" if $mode->[1] ne $default->[1];
+    push @problems, "output differs" if $mode->[0] ne $default->[0];
+    return @problems;
+}
+
+# As compare_same, for a pipeline whose parser writes a binary AST: where
+# parsing fails, only the lex and parse errors can be compared.
+sub compare_parsed {
+    my ($default, $mode) = @_;
+    return compare_same($default, $mode)
+	unless $default->[1] =~ /^(.*lex and parse errors\n)/s;
+    my $parse_errors = $1;
+    my @problems;
+    push @problems, "exit status 0 after parse errors" if $mode->[2] == 0;
+    push @problems, "parse errors differ"
+	if substr($mode->[1], 0, length($parse_errors)) ne $parse_errors;
+    return @problems;
+}
+
+#
+# Modes: each gives the programs it needs besides lexer and parser, the
+# environment and command to run an input with, and compares the result
+# with the default run, returning a list of problems.
+#
+my %modes = (
+    "binary" => {
+	programs => [$binary_parser, $binary_semant],
+	env => "",
+	cmd => sub {
+	    my ($input) = @_;
+	    return "$lexer $input | $binary_parser | $binary_semant";
+	},
+	compare => \&compare_parsed,
+    },
+    "image" => {
+	programs => [$binary_parser, $ast_image, $image_semant],
+	env => "",
+	cmd => sub {
+	    my ($input) = @_;
+	    return "$lexer $input | $binary_parser | $ast_image > $work_dir/image && " .
+		"$image_semant < $work_dir/image";
+	},
+	compare => \&compare_parsed,
+    },
+    "memo" => {
+	programs => [],
+	env => "COOL_SEMANT_MEMO=1",
+	cmd => \&semant_cmd,
+	compare => sub {
+	    my ($default, $mode) = @_;
+	    my @result = @$mode;
+	    $result[1] =~ s/^memo: .*\n//mg;
+	    return compare_same($default, \@result);
+	},
+    },
+    "parallel" => {
+	programs => [],
+	env => "COOL_SEMANT_THREADS=3",
+	cmd => \&semant_cmd,
+	compare => \&compare_same,
+    },
+    "stream" => {
+	programs => [],
+	env => "COOL_SEMANT_STREAM=1",
+	cmd => \&semant_cmd,
+	compare => sub {
+	    my ($default, $mode) = @_;
+	    my @problems;
+	    push @problems, "exit status $mode->[2], expected $default->[2]"
+		if $mode->[2] != $default->[2];
+	    push @problems, "errors differ" if $mode->[1] ne $default->[1];
+	    if ($default->[2] == 0) {
+		push @problems, "output differs" if $mode->[0] ne $default->[0];
+	    } elsif ($default->[1] !~ /static semantic errors/) {
+		# Lex and parse errors stop the pipeline before semant.
+	    } elsif (substr($mode->[0], -length($halted)) ne $halted) {
+		push @problems, "output does not end with the halted marker";
+	    }
+	    return @problems;
+	},
+    },
+);
+
+my @mode_names;
+foreach my $name (sort keys %modes) {
+    my @missing = grep { !-x $_ } @{$modes{$name}->{programs}};
+    if (@missing) {
+	print "$name: skipped, $missing[0] not found\n";
+    } else {
+	push @mode_names, $name;
+    }
+}
+
+my $failures = 0;
+foreach my $input (sort glob("$grading_dir/*.test")) {
+    $input =~ s/^\.\///;     # as the file names in expected outputs are
+    my @default = run("", semant_cmd($input));
+    foreach my $name (@mode_names) {
+	my $mode = $modes{$name};
+	my @result = run($mode->{env}, $mode->{cmd}->($input));
+	my @problems = $mode->{compare}->(\@default, \@result);
+	my $expected = "$input.$name";
+	push @problems, "output differs from $expected"
+	    if -f $expected && $result[0] ne slurp($expected);
+	foreach my $problem (@problems) {
+	    print "$input: $name: $problem\n";
+	    $failures++;
+	}
+	print "$input: $name: ok\n" if $verbose && !@problems;
+    }
+}
+
+my $deep_chain = 200000;
+my $deep_input = "$work_dir/deep.cl";
+open(DEEP, ">$deep_input") || die "Cannot write $deep_input\n";
+print DEEP "class Main {\n    main() : Int { 1", " + 1" x $deep_chain, " };\n};\n";
+close(DEEP);
+foreach my $name (grep { $_ eq "binary" || $_ eq "image" } @mode_names) {
+    my @result = run("", $modes{$name}->{cmd}->($deep_input));
+    my $additions = () = $result[0] =~ /^ *_plus\n/mg;
+    my @problems;
+    push @problems, "exit status $result[2], expected 0" if $result[2] != 0;
+    push @problems, "errors reported" if $result[1] ne "";
+    push @problems, "$additions additions in the output, expected $deep_chain"
+	if $additions != $deep_chain;
+    foreach my $problem (@problems) {
+	print "deep chain: $name: $problem\n";
+	$failures++;
+    }
+    print "deep chain: $name: ok\n" if $verbose && !@problems;
+}
+
+print $failures ? "$failures mismatches\n" : "All modes match the default path\n";
+exit($failures ? 1 : 0);
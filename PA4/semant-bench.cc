@@ -0,0 +1,196 @@
+/*
+ * semant-bench.cc
+ *          Benchmark driver for semantic analysis.
+ *
+ * This is a drop-in replacement for semant-phase.cc: it reads an AST from
+ * standard input (the output of the parser phase), but instead of dumping
+ * the typed AST it times the call to semant and prints one line of
+ * statistics to standard output:
+ *
+ *      semant_usec=<n> classes=<n> alloc_bytes=<n> allocs=<n> threads=<n>
+ *
+ * Only semantic analysis is timed. alloc_bytes and allocs count every
+ * operator new issued while it runs. Classes are checked on
+ * COOL_SEMANT_THREADS threads, as in semant. With COOL_SEMANT_MEMO=1 the
+ * types of repeated subexpressions are memoized, as in semant, and the
+ * line ends with the memo's counts:
+ *
+ *      ... memo_lookups=<n> memo_hits=<n> memo_reused_nodes=<n>
+ *
+ * With COOL_SEMANT_BENCH_WARM=1 semant also writes the typed AST, class by
+ * class, to a stream that discards it, and the line ends with
+ *
+ *      ... warm_allocs=<n>
+ *
+ * the allocations made after the first class was checked and written. By
+ * then the class table is built and the checker set up, so this is what
+ * checking the rest of the program costs once warm.
+ *
+ * With COOL_SEMANT_BENCH_EDIT=<file>, where file holds the AST of an edited
+ * version of the program, the program is checked with a SemantCache (so on
+ * one thread and without the memo), then the edited version is read and
+ * checked with the same cache, and the line ends with
+ *
+ *      ... edit_usec=<n> edit_checked=<n> edit_reused=<n>
+ *
+ * the time to recheck after the edit and the classes rechecked and reused.
+ * semant_usec is then the time of the first check, which fills the cache.
+ *
+ * Programs with semantic errors are reported on standard error and exit
+ * with status 1, like semant.
+ *
+ * Build it from the objects of `make semant', substituting this file for
+ * semant-phase.o, e.g.
+ *
+ *      g++ -g -Wall -Wno-unused -Wno-write-strings -I. \
+ *          -I/usr/class/cs143/cool/include/PA4 -I/usr/class/cs143/cool/src/PA4 \
+ *          semant-bench.cc semant.o ast-lex.o ast-parse.o handle_flags.o \
+ *          utilities.o stringtab.o tree.o cool-tree.o dumptype.o \
+ *          -lpthread -o semant-bench
+ *
+ * semant-bench.pl runs it over the grading tests and generated programs.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <new>
+#include "cool-tree.h"
+#include "semant.h"
+#include "utilities.h"
+
+//
+// Globals normally provided by semant-phase.cc.
+//
+extern Program ast_root;        // root of the abstract syntax tree
+FILE *ast_file = stdin;         // we read the AST from standard input
+extern int ast_yyparse(void);   // entry point to the AST parser
+extern void ast_yyrestart(FILE *);      // points the AST lexer at a new file
+int cool_yydebug;               // not used, but needed to link with handle_flags
+char *curr_filename;
+void handle_flags(int argc, char *argv[]);
+
+/*
+ * Allocation accounting. Counting is only switched on around semant so
+ * that reading the AST is not charged to it.
+ */
+static bool count_allocs = false;
+static size_t alloc_bytes = 0;
+static size_t alloc_count = 0;
+
+void *operator new(size_t size) {
+    if (count_allocs) {
+        alloc_bytes += size;
+        alloc_count++;
+    }
+    void *p = malloc(size ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *p) { free(p); }
+void operator delete[](void *p) { free(p); }
+
+/*
+ * Discards the typed AST. semant flushes it after each class, and each
+ * flush records the allocation count.
+ */
+class class_marks : public std::streambuf {
+public:
+    int classes;
+    size_t first, last;         // allocations after the first and last class
+
+    class_marks() : classes(0), first(0), last(0) { }
+
+protected:
+    int overflow(int c) { return c == EOF ? 0 : c; }
+    int sync() {
+        if (classes++ == 0)
+            first = alloc_count;
+        last = alloc_count;
+        return 0;
+    }
+};
+
+static long elapsed_usec(struct timeval &start, struct timeval &end) {
+    return (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+}
+
+int main(int argc, char *argv[]) {
+    handle_flags(argc, argv);
+    ast_yyparse();
+    Classes classes = static_cast<program_class *>(ast_root)->get_classes();
+
+    const char *env_threads = getenv("COOL_SEMANT_THREADS");
+    int threads = env_threads != NULL ? atoi(env_threads) : 1;
+    const char *env_memo = getenv("COOL_SEMANT_MEMO");
+    bool memoize = env_memo != NULL && atoi(env_memo) != 0;
+    memo_stats memo;
+    const char *env_warm = getenv("COOL_SEMANT_BENCH_WARM");
+    bool warm = env_warm != NULL && atoi(env_warm) != 0;
+    class_marks marks;
+    ostream typed(&marks);
+    const char *edit_file = getenv("COOL_SEMANT_BENCH_EDIT");
+    SemantCache cache;
+    if (edit_file != NULL) {
+        threads = 1;            // as semant does with a cache
+        memoize = false;
+    }
+
+    struct timeval start, end;
+    count_allocs = true;
+    gettimeofday(&start, NULL);
+    int errors = ast_root->semant(cerr, edit_file != NULL ? &cache : NULL, threads,
+                                  memoize ? &memo : NULL, NULL, warm ? &typed : NULL);
+    gettimeofday(&end, NULL);
+    count_allocs = false;
+
+    if (errors != 0) {
+        cerr << "Compilation halted due to static semantic errors." << endl;
+        exit(1);
+    }
+    long usec = elapsed_usec(start, end);
+
+    long edit_usec = 0;
+    if (edit_file != NULL) {
+        ast_file = fopen(edit_file, "r");
+        if (ast_file == NULL) {
+            cerr << "Could not open input file " << edit_file << endl;
+            exit(1);
+        }
+        ast_yyrestart(ast_file);
+        ast_yyparse();
+        fclose(ast_file);
+
+        gettimeofday(&start, NULL);
+        errors = ast_root->semant(cerr, &cache);
+        gettimeofday(&end, NULL);
+        if (errors != 0) {
+            cerr << "Compilation halted due to static semantic errors." << endl;
+            exit(1);
+        }
+        edit_usec = elapsed_usec(start, end);
+    }
+
+    cout << "semant_usec=" << usec
+         << " classes=" << classes->len()
+         << " alloc_bytes=" << alloc_bytes
+         << " allocs=" << alloc_count
+         << " threads=" << threads;
+    if (memoize)
+        cout << " memo_lookups=" << memo.lookups
+             << " memo_hits=" << memo.hits
+             << " memo_reused_nodes=" << memo.reused_nodes;
+    if (warm)
+        cout << " warm_allocs=" << marks.last - marks.first;
+    if (edit_file != NULL)
+        cout << " edit_usec=" << edit_usec
+             << " edit_checked=" << cache.checked
+             << " edit_reused=" << cache.reused;
+    cout << endl;
+    return 0;
+}
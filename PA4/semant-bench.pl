@@ -0,0 +1,370 @@
+#!/usr/bin/perl -w
+#
+# semant-bench.pl
+#
+# Benchmark for semantic analysis.
+#
+# Usage:
+#   semant-bench.pl [options]
+#
+# Runs the lexer and parser once over every grading/*.test file plus a set
+# of generated programs (deep class hierarchies in particular), then feeds
+# each AST to semant-bench, which times only semantic analysis (see
+# semant-bench.cc). Inputs with lex, parse or semantic errors are skipped.
+# With -baseline, a second semant-bench (say, one built from an older
+# semant.cc) is timed on the same ASTs and the speedup is reported.
+# With -memo, semant-bench memoizes the types of repeated subexpressions
+# (COOL_SEMANT_MEMO=1) and the memo's hit rate is reported; the baseline,
+# which may be the same driver, runs without.
+# With -edit <n>, semant-bench also times rechecking a generated program of
+# n classes after an edit to one of them, with the results of the first
+# check kept in a SemantCache (COOL_SEMANT_BENCH_EDIT), against checking the
+# edited program from scratch.
+#
+
+use strict;
+
+use File::Temp qw(tempdir);
+use Getopt::Long;
+
+my $lexer = "../PA2/lexer";
+my $parser = "../PA3/parser";
+my $bench = "./semant-bench";
+my $baseline;
+my $grading_dir = "./grading";
+my $reps = 3;
+my $size = 1000;
+my $keep;
+my $memo;
+my $edit;
+
+sub usage {
+    print "Usage: $0 [options]\n";
+    print "    Options: -lexer <path>    - lexer phase [default = \"$lexer\"]\n";
+    print "             -parser <path>   - parser phase [default = \"$parser\"]\n";
+    print "             -bench <path>    - semant benchmark driver [default = \"$bench\"]\n";
+    print "             -baseline <path> - semant benchmark driver to compare against\n";
+    print "             -dir <path>      - directory of *.test inputs [default = \"$grading_dir\"]\n";
+    print "             -reps <n>        - runs per input; the fastest is reported [default = $reps]\n";
+    print "             -size <n>        - size of the generated programs [default = $size]\n";
+    print "             -keep            - keep generated programs and ASTs\n";
+    print "             -memo            - memoize subexpression types in the benchmark driver\n";
+    print "             -edit <n>        - time rechecking n classes after an edit to one\n";
+    return "\n";
+}
+
+die usage()
+    unless(GetOptions("lexer=s" => \$lexer,
+		      "parser=s" => \$parser,
+		      "bench=s" => \$bench,
+		      "baseline=s" => \$baseline,
+		      "dir=s" => \$grading_dir,
+		      "reps=i" => \$reps,
+		      "size=i" => \$size,
+		      "keep" => \$keep,
+		      "memo" => \$memo,
+		      "edit=i" => \$edit));
+
+foreach my $driver ($bench, defined($baseline) ? ($baseline) : ()) {
+    die "$driver not found; see semant-bench.cc for how to build it\n" unless -x $driver;
+}
+
+my $work_dir = tempdir("semant-bench-XXXXXX", TMPDIR => 1, CLEANUP => !$keep);
+
+#
+# Generated programs.
+#
+
+# class C1 inherits IO ... class Cn inherits Cn-1, one inheritance chain.
+sub gen_chain {
+    my ($n) = @_;
+    my $prog = "class C1 inherits IO {\n};\n";
+    for (my $i = 2; $i <= $n; $i++) {
+	$prog .= "class C$i inherits C" . ($i - 1) . " {\n};\n";
+    }
+    return $prog;
+}
+
+# let x1 : C1 <- new Cn, ... xn : C1 <- new Cn in x1: n checks, each of
+# which walks the whole chain if is_child is linear in the depth.
+sub gen_deep_subtype {
+    my ($n) = @_;
+    my @bindings;
+    for (my $i = 1; $i <= $n; $i++) {
+	push @bindings, "x$i : C1 <- new C$n";
+    }
+    return gen_chain($n) . "class Main {\n  main() : Object {\n    let " .
+	join(",\n        ", @bindings) . "\n    in x1\n  };\n};\n";
+}
+
+# xi : C1 <- if true then new Cn else new Cn-1 fi, n times: every lub is
+# between two classes at the bottom of the chain.
+sub gen_deep_lub {
+    my ($n) = @_;
+    my @bindings;
+    for (my $i = 1; $i <= $n; $i++) {
+	push @bindings, "x$i : C1 <- if true then new C$n else new C" . ($n - 1) . " fi";
+    }
+    return gen_chain($n) . "class Main {\n  main() : Object {\n    let " .
+	join(",\n        ", @bindings) . "\n    in x1\n  };\n};\n";
+}
+
+# xi : Int <- (new Cn).f(i), n times, where only C1 defines f: every
+# lookup of f starts at the bottom of the chain.
+sub gen_deep_dispatch {
+    my ($n) = @_;
+    my $prog = gen_chain($n);
+    $prog =~ s/class C1 inherits IO \{\n/class C1 inherits IO {\n  f(x : Int) : Int { x };\n/;
+    my @bindings;
+    for (my $i = 1; $i <= $n; $i++) {
+	push @bindings, "x$i : Int <- (new C$n).f($i)";
+    }
+    return $prog . "class Main {\n  main() : Object {\n    let " .
+	join(",\n        ", @bindings) . "\n    in x1\n  };\n};\n";
+}
+
+# let x1 : Int <- 0, x2 : Int <- x1, ... xn : Int <- x1 in xn: n nested
+# scopes, and each lookup of x1 is made from the innermost one so far.
+sub gen_deep_let {
+    my ($n) = @_;
+    my @bindings = ("x1 : Int <- 0");
+    for (my $i = 2; $i <= $n; $i++) {
+	push @bindings, "x$i : Int <- x1";
+    }
+    return "class Main {\n  main() : Object {\n    let " .
+	join(",\n        ", @bindings) . "\n    in x$n\n  };\n};\n";
+}
+
+# n methods, each binding eight formals, eight let variables and two case
+# branches: object map traffic with little else.
+sub gen_many_bindings {
+    my ($n) = @_;
+    my $prog = "class Main {\n  main() : Object { 0 };\n";
+    for (my $i = 1; $i <= $n; $i++) {
+	$prog .= "  m$i(" . join(", ", map { "a$_ : Int" } 1 .. 8) . ") : Int {\n" .
+	    "    let " . join(", ", map { "b$_ : Int <- a$_" } 1 .. 8) . " in\n" .
+	    "      case b8 of x : Int => x + a1; y : Object => b1; esac\n  };\n";
+    }
+    return $prog . "};\n";
+}
+
+# The chain alone with an empty Main: validating the hierarchy is quadratic
+# in the depth if it walks the ancestors of every class.
+sub gen_long_chain {
+    my ($n) = @_;
+    return gen_chain($n) . "class Main {\n  main() : Object { 0 };\n};\n";
+}
+
+# The chain with an attribute in every class, initialized from the one in
+# C1: the classes inherit n(n-1)/2 attributes in all.
+sub gen_deep_attrs {
+    my ($n) = @_;
+    my $prog = gen_chain($n);
+    $prog =~ s/class C(\d+) inherits (\w+) \{\n/class C$1 inherits $2 {\n  a$1 : Int <- a1;\n/g;
+    return $prog . "class Main {\n  main() : Object { new C$n };\n};\n";
+}
+
+# { (new Cn).f(1); ... (new Cn).f(n); } over the chain: n dispatches and
+# nothing else, for the check below that checking them allocates nothing.
+sub gen_many_dispatches {
+    my ($n) = @_;
+    my $prog = gen_chain($n);
+    $prog =~ s/class C1 inherits IO \{\n/class C1 inherits IO {\n  f(x : Int) : Int { x };\n/;
+    my @calls;
+    for (my $i = 1; $i <= $n; $i++) {
+	push @calls, "(new C$n).f($i);";
+    }
+    return $prog . "class Main {\n  main() : Object {\n    {\n      " .
+	join("\n      ", @calls) . "\n    }\n  };\n};\n";
+}
+
+# case new Cn of x1 : C1 => 1; ... xn : Cn => n; esac over the chain: one
+# case with n branches, all of distinct types.
+sub gen_wide_case {
+    my ($n) = @_;
+    my @branches;
+    for (my $i = 1; $i <= $n; $i++) {
+	push @branches, "x$i : C$i => $i;";
+    }
+    return gen_chain($n) . "class Main {\n  main() : Object {\n    case new C$n of\n      " .
+	join("\n      ", @branches) . "\n    esac\n  };\n};\n";
+}
+
+# n methods with the same body, which repeats its subexpressions too:
+# what the memo (semant-bench -memo) is for.
+sub gen_repeated_exprs {
+    my ($n) = @_;
+    my $prog = "class Main inherits IO {\n  x : Int;\n  s : String;\n" .
+	"  main() : Object { 0 };\n  f(a : Int, b : Int) : Int { a + b };\n";
+    for (my $i = 1; $i <= $n; $i++) {
+	$prog .= "  m$i(a : Int) : Object {\n" .
+	    "    let y : Int <- f(x + 1, s.length() * 2) in {\n" .
+	    "      out_int(f(x + 1, s.length() * 2) + y);\n" .
+	    "      if f(x + 1, s.length() * 2) < y then s.concat(\"a\").length() else a fi;\n" .
+	    "    }\n  };\n";
+    }
+    return $prog . "};\n";
+}
+
+# n classes, each with a few methods, one of which calls the class before
+# it. With $edited, the body of one method in the middle is changed, which
+# leaves every interface as it was: only that class needs rechecking.
+sub gen_edit_program {
+    my ($n, $edited) = @_;
+    my $prog = "";
+    for (my $i = 1; $i <= $n; $i++) {
+	my $prev = $i > 1 ? "K" . ($i - 1) : "Int";
+	my $call = $i > 1 ? "k.get()" : "k";
+	my $body = $edited && $i == int($n / 2) ? "v + 1" : "v";
+	$prog .= "class K$i inherits IO {\n  v : Int <- $i;\n  s : String <- \"k$i\";\n" .
+	    "  get() : Int { $body };\n" .
+	    "  sum(k : $prev) : Int { $call + v };\n" .
+	    "  count(n : Int) : Int {\n" .
+	    "    let i : Int <- 0, t : Int <- 0 in {\n" .
+	    "      while i < n loop { t <- t + i * v; i <- i + 1; } pool;\n" .
+	    "      if t < 0 then 0 - t else t fi;\n" .
+	    "    }\n  };\n" .
+	    "  show() : SELF_TYPE { out_string(s.concat(\" \")).out_int(count(v)) };\n" .
+	    "};\n";
+    }
+    return $prog . "class Main {\n  main() : Object { (new K$n).show() };\n};\n";
+}
+
+my %generators = (
+    "deep_attrs" => \&gen_deep_attrs,
+    "deep_dispatch" => \&gen_deep_dispatch,
+    "deep_let" => \&gen_deep_let,
+    "deep_lub" => \&gen_deep_lub,
+    "deep_subtype" => \&gen_deep_subtype,
+    "long_chain" => \&gen_long_chain,
+    "many_dispatches" => \&gen_many_dispatches,
+    "many_bindings" => \&gen_many_bindings,
+    "repeated_exprs" => \&gen_repeated_exprs,
+    "wide_case" => \&gen_wide_case,
+);
+
+my @inputs = sort glob("$grading_dir/*.test");
+foreach my $name (sort keys %generators) {
+    my $file = "$work_dir/$name.cl";
+    open(OUT, ">$file") || die "Cannot write $file: $!\n";
+    print OUT $generators{$name}->($size);
+    close(OUT);
+    push @inputs, $file;
+}
+
+# Fastest of $reps runs of $driver on $ast_file, as (usec, classes, bytes,
+# allocs, memo lookups, memo hits), memoizing if $with_memo.
+sub run_bench {
+    my ($driver, $ast_file, $with_memo) = @_;
+    my $env = $with_memo ? "COOL_SEMANT_MEMO=1" : "COOL_SEMANT_MEMO=0";
+    my @best;
+    for (my $i = 0; $i < $reps; $i++) {
+	my $result = `$env $driver < $ast_file 2>/dev/null`;
+	return () unless $? == 0 &&
+	    $result =~ /semant_usec=(\d+) classes=(\d+) alloc_bytes=(\d+) allocs=(\d+)/;
+	my @run = ($1, $2, $3, $4, 0, 0);
+	@run[4, 5] = ($1, $2) if $result =~ /memo_lookups=(\d+) memo_hits=(\d+)/;
+	@best = @run if !@best || $run[0] < $best[0];
+    }
+    return @best;
+}
+
+sub hit_rate {
+    my ($lookups, $hits) = @_;
+    return sprintf("%.1f%%", $lookups > 0 ? 100 * $hits / $lookups : 0);
+}
+
+#
+# Lex and parse once, then run semant-bench on each AST.
+#
+my ($total_usec, $total_base_usec, $total_bytes, $total_allocs) = (0, 0, 0, 0);
+my ($total_lookups, $total_hits) = (0, 0);
+my $skipped = 0;
+
+printf("%-32s %8s %10s %10s %12s %10s", "input", "classes", "usec", "classes/s", "bytes", "allocs");
+printf(" %10s %8s", "memo_hits", "hit_rate") if $memo;
+printf(" %10s %8s", "base_usec", "speedup") if defined($baseline);
+print "\n";
+
+foreach my $input (@inputs) {
+    my $name = $input;
+    $name =~ s/.*\///;
+    my $ast_file = "$work_dir/$name.ast";
+    if (system("$lexer $input | $parser > $ast_file 2>/dev/null") != 0) {
+	$skipped++;
+	next;
+    }
+
+    my ($usec, $classes, $bytes, $allocs, $lookups, $hits) = run_bench($bench, $ast_file, $memo);
+    if (!defined($usec)) {
+	# Inputs with errors are part of the grading set; skip them.
+	$skipped++;
+	next;
+    }
+    my $secs = ($usec > 0 ? $usec : 1) / 1e6;
+    printf("%-32s %8d %10d %10.0f %12d %10d", $name, $classes, $usec, $classes / $secs, $bytes, $allocs);
+    printf(" %10d %8s", $hits, hit_rate($lookups, $hits)) if $memo;
+    if (defined($baseline)) {
+	my ($base_usec) = run_bench($baseline, $ast_file, 0);
+	$base_usec = 0 unless defined($base_usec);
+	printf(" %10d %7.2fx", $base_usec, $base_usec / ($usec > 0 ? $usec : 1));
+	$total_base_usec += $base_usec;
+    }
+    print "\n";
+    $total_usec += $usec;
+    $total_bytes += $bytes;
+    $total_allocs += $allocs;
+    $total_lookups += $lookups;
+    $total_hits += $hits;
+}
+
+printf("%-32s %8s %10d %10s %12d %10d", "TOTAL", "", $total_usec, "", $total_bytes, $total_allocs);
+printf(" %10d %8s", $total_hits, hit_rate($total_lookups, $total_hits)) if $memo;
+printf(" %10d %7.2fx", $total_base_usec, $total_base_usec / ($total_usec > 0 ? $total_usec : 1))
+    if defined($baseline);
+print "\n";
+print "($skipped inputs with errors skipped)\n" if $skipped;
+
+#
+# Once the class table is built and the checker set up, a dispatch looks
+# its method up in a table built beforehand and keeps its argument types
+# on the checker's stacks, so checking dispatches allocates nothing.
+#
+my $warm_input = "$work_dir/many_dispatches.cl.ast";
+my $warm = `COOL_SEMANT_BENCH_WARM=1 $bench < $warm_input 2>/dev/null`;
+die "many_dispatches.cl: no warm_allocs from $bench\n"
+    unless $warm =~ /warm_allocs=(\d+)/;
+die "many_dispatches.cl: $1 allocations after the first class, expected none\n"
+    if $1 != 0;
+print "many_dispatches.cl: no allocations after the first class\n";
+
+#
+# Rechecking after an edit, against checking the edited program from
+# scratch.
+#
+if ($edit) {
+    my @ast_files;
+    foreach my $version ("original", "edited") {
+	my $file = "$work_dir/edit_$version.cl";
+	open(OUT, ">$file") || die "Cannot write $file: $!\n";
+	print OUT gen_edit_program($edit, $version eq "edited");
+	close(OUT);
+	system("$lexer $file | $parser > $file.ast 2>/dev/null") == 0
+	    || die "edit_$version.cl: lex or parse errors\n";
+	push @ast_files, "$file.ast";
+    }
+    my ($first, $recheck, $checked, $reused);
+    for (my $i = 0; $i < $reps; $i++) {
+	my $result = `COOL_SEMANT_BENCH_EDIT=$ast_files[1] $bench < $ast_files[0] 2>/dev/null`;
+	die "edit_original.cl: no edit_usec from $bench\n"
+	    unless $result =~ /semant_usec=(\d+) .*edit_usec=(\d+) edit_checked=(\d+) edit_reused=(\d+)/;
+	($first, $recheck, $checked, $reused) = ($1, $2, $3, $4)
+	    if !defined($recheck) || $2 < $recheck;
+    }
+    my ($scratch) = run_bench($bench, $ast_files[1], 0);
+    die "edit_edited.cl: no semant_usec from $bench\n" unless defined($scratch);
+    printf("edit of one class in %d: %d usec from scratch, %d usec rechecking " .
+	   "(%d classes rechecked, %d reused; first check %d usec)\n",
+	   $edit, $scratch, $recheck, $checked, $reused, $first);
+}
+print "Generated programs kept in $work_dir\n" if $keep;
@@ -1 +0,0 @@
-/usr/class/cs143/cool/src/PA4/semant-phase.cc
\ No newline at end of file
@@ -0,0 +1,181 @@
+/*
+ * semant-phase.cc
+ *          Driver for the semantic analysis phase.
+ *
+ * Reads the text AST the parser wrote from standard input, analyzes it and
+ * writes the typed AST to standard output as dump_with_types text, ready
+ * for cgen. This is the course's driver with two additions.
+ *
+ * When COOL_SEMANT_STREAM is set, each class is written as soon as it has
+ * been checked (see program_class::semant_streaming), so that cgen can
+ * start reading while semant is still at work. On semantic errors the
+ * stream ends with SEMANT_STREAM_HALTED (see semant.h), and semant exits
+ * with status 1 either way.
+ *
+ * With -b manifest (see handle_flags.cc), semant checks many independent
+ * programs in one process instead:
+ *
+ *      semant -b manifest [-j threads]
+ *
+ * Each non-empty line of the manifest that doesn't start with '#' names a
+ * file holding the parser's AST of one program. The ASTs are read in turn
+ * (the AST parser keeps its state in globals), and the programs are then
+ * checked concurrently on a pool of threads, by default one per CPU.
+ * semant only reads the string tables and the basic classes, which are set
+ * up once per process, so programs need nothing of their own beyond their
+ * ClassTable and an error stream, which semant(ostream&) already provides.
+ *
+ * The output of each program is what semant would print for it alone,
+ * errors included, after a line naming its file:
+ *
+ *      ==> file.ast <==
+ *
+ * Programs are printed in manifest order. A summary goes to standard error,
+ *
+ *      programs=<n> failed=<n> threads=<n> parse_usec=<n> semant_usec=<n>
+ *
+ * and the exit status is 1 if any program had errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "cool-tree.h"
+#include "utilities.h"
+
+extern Program ast_root;        // root of the abstract syntax tree
+FILE *ast_file = stdin;         // we read the AST from standard input
+extern int ast_yyparse(void);   // entry point to the AST parser
+extern void ast_yyrestart(FILE *);
+
+int cool_yydebug;               // not used, but needed to link with handle_flags
+char *curr_filename;
+
+extern char *batch_manifest;    // -b, see handle_flags.cc
+extern int batch_threads;       // -j
+
+void handle_flags(int argc, char *argv[]);
+
+struct batch_program {
+    std::string file;
+    Program ast;                // NULL if the AST couldn't be read
+    int status;
+    std::string output;         // what semant would print for it alone
+};
+
+static std::vector<batch_program> programs;
+static size_t next_program = 0;
+static pthread_mutex_t next_program_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void read_manifest(const char *path) {
+    std::ifstream manifest(path);
+    if (!manifest) {
+        cerr << "Could not open manifest " << path << endl;
+        exit(1);
+    }
+    std::string line;
+    while (std::getline(manifest, line)) {
+        std::istringstream words(line);
+        batch_program p;
+        if (!(words >> p.file) || p.file[0] == '#')
+            continue;
+        p.ast = NULL;
+        p.status = 1;
+        programs.push_back(p);
+    }
+}
+
+/* Reads the AST of p, or records why it couldn't as p's output. */
+static void parse(batch_program& p) {
+    ast_file = fopen(p.file.c_str(), "r");
+    if (ast_file == NULL) {
+        p.output = "Could not open input file " + p.file + "\n";
+        return;
+    }
+    ast_root = NULL;
+    ast_yyrestart(ast_file);
+    if (ast_yyparse() == 0 && ast_root != NULL)
+        p.ast = ast_root;
+    else
+        p.output = "Could not read an AST from " + p.file + "\n";
+    fclose(ast_file);
+}
+
+static void check(batch_program& p) {
+    std::ostringstream output;
+    if (p.ast->semant(output) != 0)
+        output << "Compilation halted due to static semantic errors." << endl;
+    else {
+        p.ast->dump_with_types(output, 0);
+        p.status = 0;
+    }
+    p.output = output.str();
+}
+
+static void *check_programs(void *) {
+    for (;;) {
+        pthread_mutex_lock(&next_program_lock);
+        size_t i = next_program++;
+        pthread_mutex_unlock(&next_program_lock);
+        if (i >= programs.size())
+            return NULL;
+        if (programs[i].ast != NULL)
+            check(programs[i]);
+    }
+}
+
+static long elapsed_usec(struct timeval &start, struct timeval &end) {
+    return (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+}
+
+static int semant_batch(const char *manifest) {
+    int threads = batch_threads > 0 ? batch_threads : sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1)
+        threads = 1;
+    read_manifest(manifest);
+
+    struct timeval start, parsed, checked;
+    gettimeofday(&start, NULL);
+    for (size_t i = 0; i < programs.size(); i++)
+        parse(programs[i]);
+    gettimeofday(&parsed, NULL);
+
+    std::vector<pthread_t> workers(threads);
+    for (int i = 0; i < threads; i++)
+        pthread_create(&workers[i], NULL, check_programs, NULL);
+    for (int i = 0; i < threads; i++)
+        pthread_join(workers[i], NULL);
+    gettimeofday(&checked, NULL);
+
+    int failed = 0;
+    for (size_t i = 0; i < programs.size(); i++) {
+        batch_program& p = programs[i];
+        cout << "==> " << p.file << " <==" << endl << p.output;
+        failed += p.status;
+    }
+
+    cerr << "programs=" << programs.size() << " failed=" << failed
+         << " threads=" << threads
+         << " parse_usec=" << elapsed_usec(start, parsed)
+         << " semant_usec=" << elapsed_usec(parsed, checked) << endl;
+    return failed != 0;
+}
+
+int main(int argc, char *argv[]) {
+    handle_flags(argc, argv);
+    if (batch_manifest != NULL)
+        return semant_batch(batch_manifest);
+    ast_yyparse();
+    if (getenv("COOL_SEMANT_STREAM") != NULL)
+        ast_root->semant_streaming(cout);
+    else {
+        ast_root->semant();
+        ast_root->dump_with_types(cout, 0);
+    }
+    return 0;
+}
@@ -3,12 +3,19 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <deque>
+#include <fstream>
 #include "semant.h"
 #include "utilities.h"
 
 
 extern int semant_debug;
 extern char *curr_filename;
+extern char *semant_profile_file;       // -P, see handle_flags.cc
 
 //////////////////////////////////////////////////////////////////////
 //
@@ -47,9 +54,11 @@ static Symbol
     type_name,
     val;
 //
-// Initializing the predefined symbols.
+// Initializing the predefined symbols. They are interned once per process,
+// since a compile server or a batch runs semantic analysis many times,
+// possibly on several threads at once.
 //
-static void initialize_constants(void)
+static bool intern_constants(void)
 {
     arg         = idtable.add_string("arg");
     arg2        = idtable.add_string("arg2");
@@ -79,21 +88,46 @@ static void initialize_constants(void)
     substr      = idtable.add_string("substr");
     type_name   = idtable.add_string("type_name");
     val         = idtable.add_string("_val");
+    return true;
+}
+
+static void initialize_constants(void)
+{
+    static bool interned = intern_constants();    // thread-safe initialization
+    (void) interned;
 }
 
-ClassTable::ClassTable(Classes classes) : semant_errors(0) , error_stream(cerr) {
+ClassTable::ClassTable(Classes classes, ostream& err) : semant_errors(0) , error_stream(&err),
+    capture(NULL), captured(NULL), deps(NULL), memo(NULL), profile(NULL),
+    typed_out(NULL) {
 
     /* Construct inheritance graph, a graph of <child, parent> class mappings */
     /* Add basic classes */
     install_basic_classes();
 
-    /* Add other classes */
-    for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
-        add_to_class_table(classes->nth(i));
+    /* Add other classes. The tree package finds the nth element of a list
+       by walking the list, so it is walked once, here, and the rest of
+       semant goes through program_classes. */
+    int n = classes->len();
+    program_classes.reserve(n);
+    for (int i = 0; i < n; i++) {
+        program_classes.push_back(classes->nth(i));
+        add_to_class_table(program_classes.back());
     }
 }
 
+/*
+ * The basic classes are built once and shared by every ClassTable; semantic
+ * analysis never modifies them.
+ */
 void ClassTable::install_basic_classes() {
+    static Classes basic_classes = build_basic_classes();
+    for (int i = basic_classes->first(); basic_classes->more(i); i = basic_classes->next(i)) {
+        add_to_class_table(basic_classes->nth(i));
+    }
+}
+
+Classes ClassTable::build_basic_classes() {
 
     // The tree package uses these globals to annotate the classes built below.
    // curr_lineno  = 0;
@@ -193,11 +227,13 @@ void ClassTable::install_basic_classes() {
 						      no_expr()))),
 	       filename);
 
-    add_to_class_table(Object_class);
-    add_to_class_table(IO_class);
-    add_to_class_table(Int_class);
-    add_to_class_table(Bool_class);
-    add_to_class_table(Str_class);
+    return append_Classes(
+               append_Classes(
+                   append_Classes(
+                       append_Classes(single_Classes(Object_class), single_Classes(IO_class)),
+                       single_Classes(Int_class)),
+                   single_Classes(Bool_class)),
+               single_Classes(Str_class));
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -213,8 +249,33 @@ void ClassTable::install_basic_classes() {
 //    ostream& ClassTable::semant_error(Symbol filename, tree_node *t)  
 //       print a line number and filename
 //
+// While SemantCache is recording a class the error goes to its capture
+// buffer instead, and is counted when SemantCache replays it. On a thread
+// checking classes in parallel it goes to the thread's buffer, and is
+// counted when check_classes merges the buffers.
+//
 ///////////////////////////////////////////////////////////////////
 
+static pthread_key_t thread_errors_key;
+static pthread_once_t thread_errors_once = PTHREAD_ONCE_INIT;
+
+static void create_thread_errors_key()
+{
+    pthread_key_create(&thread_errors_key, NULL);
+}
+
+static thread_errors *get_thread_errors()
+{
+    pthread_once(&thread_errors_once, create_thread_errors_key);
+    return (thread_errors *) pthread_getspecific(thread_errors_key);
+}
+
+void ClassTable::set_thread_errors(thread_errors *errors)
+{
+    pthread_once(&thread_errors_once, create_thread_errors_key);
+    pthread_setspecific(thread_errors_key, errors);
+}
+
 ostream& ClassTable::semant_error(Class_ c)
 {                                                             
     return semant_error(c->get_filename(),c);
@@ -222,23 +283,68 @@ ostream& ClassTable::semant_error(Class_ c)
 
 ostream& ClassTable::semant_error(Symbol filename, tree_node *t)
 {
-    error_stream << filename << ":" << t->get_line_number() << ": ";
-    return semant_error();
+    if (capture != NULL) {
+        captured_error e = { capture->tellp(), filename, t };
+        captured->push_back(e);
+        return *capture;
+    }
+    ostream& stream = semant_error();
+    stream << filename << ":" << t->get_line_number() << ": ";
+    return stream;
 }
 
 ostream& ClassTable::semant_error()                  
 {                                                 
+    if (capture != NULL) {
+        captured_error e = { capture->tellp(), NULL, NULL };
+        captured->push_back(e);
+        return *capture;
+    }
+    thread_errors *errors = get_thread_errors();
+    if (errors != NULL) {
+        errors->count++;
+        return errors->text;
+    }
     semant_errors++;                            
-    return error_stream;
+    return *error_stream;
 } 
 
+void ClassTable::merge_errors(const std::string& text, int count)
+{
+    *error_stream << text;
+    semant_errors += count;
+}
+
+/*
+ * Writes the typed subtree of c, which has just been checked, to the typed
+ * output, as program_class::dump_with_types would. Nothing more is written
+ * once there has been an error.
+ */
+void ClassTable::write_typed(Class_ c)
+{
+    if (typed_out == NULL || semant_errors != 0)
+        return;
+    c->dump_with_types(*typed_out, 2);
+    typed_out->flush();
+}
+
+static pthread_mutex_t memo_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Adds the counts of one checker's memo; checkers may finish in parallel. */
+void ClassTable::add_memo_stats(const memo_stats& stats)
+{
+    pthread_mutex_lock(&memo_stats_lock);
+    memo->add(stats);
+    pthread_mutex_unlock(&memo_stats_lock);
+}
+
 /*
  * Other ClassTable methods
  */
 
 /*
- * Adds the class to the class table (specifically, adds it to the class map
- * and the inheritance graph) with the following caveats:
+ * Adds the class to the class table (specifically, gives it the next class ID
+ * and adds it to the inheritance graph) with the following caveats:
  * - Cannot add a class that has already been defined.
  * - Classes cannot inherit from Bool, SELF_TYPE, or String.
  * - Cannot define a SELF_TYPE class.
@@ -254,9 +360,10 @@ void ClassTable::add_to_class_table(Class_ c) {
         ostream& err_stream = semant_error(c);
         err_stream << "Redefinition of basic class " << name << ".\n";
     }
-    else if (class_map.count(name) == 0 && inheritance_graph.count(name) == 0) {
-        class_map[name] = c;
-        inheritance_graph[name] = parent;
+    else if (class_id(name) < 0) {
+        class_ids[name] = class_by_id.size();
+        class_by_id.push_back(c);
+        parent_by_id.push_back(parent);
     }
     else {
         ostream& err_stream = semant_error(c);
@@ -269,141 +376,366 @@ void ClassTable::add_to_class_table(Class_ c) {
  *   1. Every parent class is defined.
  *   2. There are no cycles.
  *   3. The class Main is defined.
+ * Every violation is reported, not just the first. A valid graph is a tree
+ * rooted at Object, which is then numbered for is_child.
  */
 bool ClassTable::is_valid() {
-    bool is_main_defined = false;
-    for (std::map<Symbol, Symbol>::iterator iter = inheritance_graph.begin();
-        iter != inheritance_graph.end(); ++iter) {
-        Symbol child = iter->first;
-        Symbol parent = iter->second;
-        if (child == Main)
-            is_main_defined = true;
-        while (parent != No_class) {
-            if (parent == child) {
-                // Error - cycle detected
-                ostream& err_stream = semant_error(class_map[child]);
-                err_stream << "Class " << child << " inherits from itself.\n";
-                return false;
+    size_t n = class_by_id.size();
+    std::vector<bool> undefined_parent(n, false);
+    std::vector<bool> on_cycle(n, false);
+    bool valid = true;
+
+    /* Walks up from each class until reaching Object or a class an earlier
+       walk has finished with, so each edge is followed once. A walk that
+       comes back to a class on its own path has closed a cycle, made of the
+       classes on the path from that class up. */
+    enum { UNVISITED, ON_PATH, DONE };
+    std::vector<char> state(n, UNVISITED);
+    std::vector<int> path;
+    for (size_t start = 0; start < n; start++) {
+        int c = start;
+        while (c >= 0 && state[c] == UNVISITED) {
+            state[c] = ON_PATH;
+            path.push_back(c);
+            Symbol parent = parent_by_id[c];
+            if (parent == No_class)
+                c = -1;
+            else if ((c = class_id(parent)) < 0) {
+                undefined_parent[path.back()] = true;
+                valid = false;
             }
-            else if (inheritance_graph.count(parent) == 0) {
-                // Error - parent not found
-                ostream& err_stream = semant_error(class_map[child]);
-                err_stream << "Class " << child << " inherits from undefined class "
-                           << parent << ".\n";
-                return false;
-            }
-            else
-                parent = inheritance_graph[parent];
         }
-    } 
-    if (is_main_defined == false) {
+        if (c >= 0 && state[c] == ON_PATH) {
+            for (int i = path.size() - 1; path[i] != c; i--)
+                on_cycle[path[i]] = true;
+            on_cycle[c] = true;
+            valid = false;
+        }
+        for (size_t i = 0; i < path.size(); i++)
+            state[path[i]] = DONE;
+        path.clear();
+    }
+
+    /* Errors are reported in Symbol order, so they do not depend on the
+       order of definition. */
+    std::vector<std::pair<Symbol, int> > order;
+    for (size_t id = 0; id < n; id++)
+        order.push_back(std::make_pair(class_by_id[id]->get_name(), (int) id));
+    std::sort(order.begin(), order.end());
+    for (size_t i = 0; i < order.size(); i++) {
+        int id = order[i].second;
+        if (on_cycle[id]) {
+            ostream& err_stream = semant_error(class_by_id[id]);
+            err_stream << "Class " << order[i].first << " inherits from itself.\n";
+        }
+        else if (undefined_parent[id]) {
+            ostream& err_stream = semant_error(class_by_id[id]);
+            err_stream << "Class " << order[i].first << " inherits from undefined class "
+                       << parent_by_id[id] << ".\n";
+        }
+    }
+
+    if (class_id(Main) < 0) {
         ostream& err_stream = semant_error();
         err_stream << "Class Main is not defined.\n";
-        return false;
+        valid = false;
+    }
+    if (valid) {
+        number_classes();
+        bind_attributes();
+    }
+    return valid;
+}
+
+/*
+ * Numbers the classes in preorder and postorder of a depth-first walk of
+ * the inheritance tree from Object, so that a class's descendants are
+ * exactly the classes whose pair of numbers nests inside its own. The same
+ * walk records the Euler tour of the tree for lub.
+ */
+void ClassTable::number_classes() {
+    size_t n = class_by_id.size();
+    std::vector<std::vector<int> > children(n);
+    parent_id.assign(n, -1);
+    for (size_t id = 0; id < n; id++) {
+        if (parent_by_id[id] != No_class) {
+            parent_id[id] = class_id(parent_by_id[id]);
+            children[parent_id[id]].push_back(id);
+        }
+    }
+
+    int number = 0;
+    int root = class_id(Object);
+    depth.assign(n, 0);
+    preorder.assign(n, 0);
+    postorder.assign(n, 0);
+    tour_first.assign(n, 0);
+    euler_tour.clear();
+    std::vector<std::pair<int, size_t> > stack;     // class, next child to visit
+    preorder[root] = number++;
+    euler_tour.push_back(root);
+    stack.push_back(std::make_pair(root, 0));
+    while (!stack.empty()) {
+        int c = stack.back().first;
+        if (stack.back().second < children[c].size()) {
+            int child = children[c][stack.back().second++];
+            depth[child] = depth[c] + 1;
+            preorder[child] = number++;
+            tour_first[child] = euler_tour.size();
+            euler_tour.push_back(child);
+            stack.push_back(std::make_pair(child, 0));
+        } else {
+            postorder[c] = number++;
+            stack.pop_back();
+            if (!stack.empty())
+                euler_tour.push_back(stack.back().first);
+        }
+    }
+
+    /* Sparse table: tour_min[k][i] is the shallowest class of
+       euler_tour[i .. i + 2^k). */
+    tour_min.assign(1, euler_tour);
+    for (size_t k = 1; (size_t) 1 << k <= euler_tour.size(); k++) {
+        const std::vector<int>& prev = tour_min[k - 1];
+        size_t half = (size_t) 1 << (k - 1);
+        std::vector<int> level(euler_tour.size() - 2 * half + 1);
+        for (size_t i = 0; i < level.size(); i++)
+            level[i] = depth[prev[i]] <= depth[prev[i + half]] ? prev[i] : prev[i + half];
+        tour_min.push_back(level);
     }
-    return true;
 }
 
 /*
  * Returns the least upper bound (least common ancestor)
  * of classes class1 and class2) in the inheritance graph.
- * This is a naive O(N^2) algorithm where N is the branch
- * length.
+ * That is the shallowest class on the Euler tour between the
+ * two classes' first visits, which the sparse table built by
+ * number_classes gives with two lookups.
  */
 Symbol ClassTable::lub(Symbol class1, Symbol class2) {
-    Symbol c1 = class1;
-    Symbol parent = Object;
-    while (c1 != Object) {
-        Symbol c2 = class2;
-        while (c2 != Object) {
-            if (c1 == c2) {
-                parent = c1;
-                goto finish;
-            }
-            c2 = inheritance_graph[c2];
-        }
-        c1 = inheritance_graph[c1];
-    }
-    finish:
-        return parent;
+    profile_count(PROFILE_LUB);
+    if (class1 == class2)
+        return class1;
+    int c1 = class_id(class1);
+    int c2 = class_id(class2);
+    if (c1 < 0 || c2 < 0)
+        return Object;
+    size_t first = std::min(tour_first[c1], tour_first[c2]);
+    size_t last = std::max(tour_first[c1], tour_first[c2]);
+    size_t k = 0;
+    while ((size_t) 2 << k <= last - first + 1)
+        k++;
+    int left = tour_min[k][first];
+    int right = tour_min[k][last + 1 - ((size_t) 1 << k)];
+    return class_by_id[depth[left] <= depth[right] ? left : right]->get_name();
 }
 
 /*
  * Returns true if child is a subclass of parent, false otherwise.
- * This is an O(N) algorithm where N is the branch length.
+ * Compares the numbers given by number_classes, so the cost does not
+ * depend on the branch length.
  */
 bool ClassTable::is_child(Symbol child, Symbol parent) {
-    Symbol c = child;
-    if (parent == Object)
+    profile_count(PROFILE_IS_CHILD);
+    if (parent == Object || child == parent)
         return true;
-    while (c != Object) {
-        if (c == parent)
-            return true;
-        c = inheritance_graph[c];
-    }
-    return false;
+    int c = class_id(child);
+    int p = class_id(parent);
+    if (c < 0 || p < 0)
+        return false;
+    return preorder[p] < preorder[c] && postorder[c] < postorder[p];
 }
 
 bool ClassTable::class_exists(Symbol c) {
-    return (inheritance_graph.count(c) > 0);
+    return class_id(c) >= 0;
 }
 
 Class_ ClassTable::get_class(Symbol class_name) {
-    return class_map[class_name];
+    depends_on(class_name);
+    int id = class_id(class_name);
+    return id >= 0 ? class_by_id[id] : NULL;
+}
+
+/* Returns the method table of a class (see build_method_tables). */
+method_table& ClassTable::get_method_table(int id) {
+    if (method_table_of.empty())
+        build_method_tables();
+    return method_tables[method_table_of[id]];
 }
 
 /*
- * Traverses the inheritance chain of the input class until
- * it finds a method matching the input method name and returns
- * the corresponding formal parameters. Returns NULL if no matching
- * method is found.
+ * Builds the flattened method table of every class: every method the class
+ * defines or inherits, with the class that defines it, which is what a
+ * dispatch table for the class would hold. Classes are visited in preorder,
+ * so each table starts as a copy of its parent's; a class that defines no
+ * methods shares its parent's table instead, so a chain of such classes
+ * costs one table. Checking calls this before any class is checked, so a
+ * dispatch only reads the tables and threads can share them.
  */
-Formals ClassTable::get_formals(Symbol class_name, Symbol method_name) {
-    Symbol cname = class_name;
-    while (cname != No_class) {
-        Class_ c = class_map[cname];
-        Formals f = c->get_formals(method_name);
-        if (f != NULL)
-            return f;
-        cname = inheritance_graph[cname]; 
+void ClassTable::build_method_tables() {
+    method_tables.clear();
+    method_tables.reserve(class_by_id.size());     // so tables never move
+    method_table_of.assign(class_by_id.size(), -1);
+    for (size_t i = 0; i < euler_tour.size(); i++) {
+        int c = euler_tour[i];
+        if (tour_first[c] != i)
+            continue;
+        Features features = class_by_id[c]->get_features();
+        bool defines_methods = false;
+        for (int j = features->first(); features->more(j) && !defines_methods; j = features->next(j))
+            defines_methods = features->nth(j)->is_method();
+        int parent = parent_id[c];
+        if (!defines_methods && parent >= 0) {
+            method_table_of[c] = method_table_of[parent];
+            continue;
+        }
+
+        method_table_of[c] = method_tables.size();
+        method_tables.push_back(parent >= 0 ? method_tables[method_table_of[parent]] : method_table());
+        method_table& table = method_tables.back();
+        Symbol name = class_by_id[c]->get_name();
+        for (int j = features->first(); features->more(j); j = features->next(j)) {
+            Feature feature = features->nth(j);
+            if (!feature->is_method())
+                continue;
+            method_info& method = table[feature->get_name()];
+            if (method.defined_in == name)
+                continue;           // only the first definition in a class counts
+            method.defined_in = name;
+            method.formals = feature->get_formals();
+            method.return_type = feature->get_return_type();
+        }
     }
-    return NULL;
 }
 
 /*
- * Traverses the inheritance chain of the input class until
- * it finds a method matching the input method name and returns
- * the corresponding formal parameters. Returns NULL if no matching
- * method is found.
+ * Looks up a method the class with the given ID defines or inherits.
+ * Returns NULL if there is no such method.
  */
-Symbol ClassTable::get_return_type(Symbol class_name, Symbol method_name) {
-    Symbol cname = class_name;
-    while (cname != No_class) {
-        Class_ c = class_map[cname];
-        Symbol r = c->get_return_type(method_name);
-        if (r != NULL)
-            return r;
-        cname = inheritance_graph[cname];
+const method_info *ClassTable::find_method(int id, Symbol method_name) {
+    const method_info *method = get_method_table(id).find(method_name);
+
+    /* The result depends on every class from this one up to the one that
+       defines the method. */
+    if (deps != NULL) {
+        for (int c = id; c >= 0; c = parent_id[c]) {
+            Symbol name = class_by_id[c]->get_name();
+            depends_on(name);
+            if (method != NULL && name == method->defined_in)
+                break;
+        }
     }
-    return NULL;
+    return method;
 }
 
 /*
- * Traverses the inheritance chain of the input class, starting with
- * the parent, until it finds a method matching the input method name
- * and returns the corresponding class name. Returns NULL if no matching
- * method is found. This is a kind of hacky solution that uses get_return_type,
- * which works because get_return_type <=> method exists in that class.
+ * Binds every attribute that is not already bound for its class, visiting
+ * the classes in preorder so that ancestors come first. An attribute that
+ * is already bound, by an ancestor or earlier in the same class, is left
+ * out and reported by attr_class::add_to_environment.
  */
-Symbol ClassTable::get_ancestor_method_class(Symbol class_name, Symbol method_name) {
-    Symbol cname = inheritance_graph[class_name];
-    while (cname != No_class) {
-        Class_ c = class_map[cname];
-        if (c->get_return_type(method_name) != NULL)
-            return c->get_name();
-        cname = inheritance_graph[cname];
+void ClassTable::bind_attributes() {
+    for (size_t i = 0; i < euler_tour.size(); i++) {
+        int c = euler_tour[i];
+        if (tour_first[c] != i)
+            continue;
+        Features features = class_by_id[c]->get_features();
+        for (int j = features->first(); features->more(j); j = features->next(j)) {
+            Feature feature = features->nth(j);
+            if (feature->is_method() || find_attribute(c, feature->get_name()) != NULL)
+                continue;
+            attr_binding binding;
+            binding.class_id = c;
+            binding.attr = feature;
+            binding.type_decl = feature->get_type();
+            attributes[feature->get_name()].push_back(binding);
+        }
     }
-    return NULL;
+}
+
+/*
+ * Looks up the attribute the class with the given ID sees under a name:
+ * the binding of the last subtree, in preorder, that starts at or before
+ * the class, if the class is in it. Returns NULL if there is none.
+ */
+attr_binding *ClassTable::find_attribute(int id, Symbol attr_name) {
+    /* Any ancestor could bind the name or, by binding it, make this class's
+       own attribute of that name a redefinition. */
+    if (deps != NULL) {
+        for (int c = id; c >= 0; c = parent_id[c])
+            depends_on(class_by_id[c]->get_name());
+    }
+
+    std::vector<attr_binding> *bindings = attributes.find(attr_name);
+    if (bindings == NULL)
+        return NULL;
+    size_t lo = 0, hi = bindings->size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (preorder[(*bindings)[mid].class_id] <= preorder[id])
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0)
+        return NULL;
+    attr_binding& binding = (*bindings)[lo - 1];
+    return postorder[id] <= postorder[binding.class_id] ? &binding : NULL;
+}
+
+/*
+ * Returns the declared type of the attribute the input class defines or
+ * inherits under the given name, or NULL if there is none. The type is
+ * held by the class table, so it can be bound in an object map.
+ */
+Symbol *ClassTable::lookup_attribute(Symbol class_name, Symbol attr_name) {
+    int id = class_id(class_name);
+    attr_binding *binding = id >= 0 ? find_attribute(id, attr_name) : NULL;
+    return binding != NULL ? &binding->type_decl : NULL;
+}
+
+/*
+ * Returns true if the attribute is the one its class sees under its name,
+ * false if it redefines an inherited attribute or an earlier one.
+ */
+bool ClassTable::binds_attribute(Symbol class_name, Feature attr) {
+    int id = class_id(class_name);
+    attr_binding *binding = id >= 0 ? find_attribute(id, attr->get_name()) : NULL;
+    return binding != NULL && binding->attr == attr;
+}
+
+/*
+ * Returns the formal parameters of the method the input class defines or
+ * inherits. Returns NULL if no matching method is found.
+ */
+Formals ClassTable::get_formals(Symbol class_name, Symbol method_name) {
+    profile_count(PROFILE_GET_FORMALS);
+    int id = class_id(class_name);
+    const method_info *method = id >= 0 ? find_method(id, method_name) : NULL;
+    return method != NULL ? method->formals : NULL;
+}
+
+/*
+ * Returns the declared return type of the method the input class defines
+ * or inherits. Returns NULL if no matching method is found.
+ */
+Symbol ClassTable::get_return_type(Symbol class_name, Symbol method_name) {
+    profile_count(PROFILE_GET_RETURN_TYPE);
+    int id = class_id(class_name);
+    const method_info *method = id >= 0 ? find_method(id, method_name) : NULL;
+    return method != NULL ? method->return_type : NULL;
+}
+
+/*
+ * Returns the nearest proper ancestor of the input class that defines
+ * the method, or NULL if no ancestor does.
+ */
+Symbol ClassTable::get_ancestor_method_class(Symbol class_name, Symbol method_name) {
+    int id = class_id(class_name);
+    if (id < 0 || parent_id[id] < 0)
+        return NULL;
+    const method_info *method = find_method(parent_id[id], method_name);
+    return method != NULL ? method->defined_in : NULL;
 }
 
 /*
@@ -416,8 +748,10 @@ Symbol ClassTable::get_ancestor_method_class(Symbol class_name, Symbol method_na
  * Does NOT ensure that the formal parameters have the same identifiers.
  */
 bool ClassTable::check_method_signature(Symbol c1, Symbol c2, Symbol method_name) {
-    Class_ class1 = class_map[c1];
-    Class_ class2 = class_map[c2];
+    depends_on(c1);
+    depends_on(c2);
+    Class_ class1 = class_by_id[class_id(c1)];
+    Class_ class2 = class_by_id[class_id(c2)];
     Formals f1 = class1->get_formals(method_name);
     Formals f2 = class2->get_formals(method_name);
     Symbol ret1 = class1->get_return_type(method_name);
@@ -440,6 +774,122 @@ bool ClassTable::check_method_signature(Symbol c1, Symbol c2, Symbol method_name
 }
 
 
+/*
+ * semant_profile methods
+ */
+
+semant_profile::semant_profile() : threads(1) {
+    for (int i = 0; i < PROFILE_COUNTERS; i++)
+        counts[i] = 0;
+}
+
+long semant_profile::now_usec() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000L + tv.tv_usec;
+}
+
+static void write_phase(ostream& out, const char *name, const profile_phase& phase) {
+    out << "    \"" << name << "\": { \"usec\": " << phase.usec
+        << ", \"calls\": " << phase.calls << " }";
+}
+
+/*
+ * Writes the profile as one JSON object:
+ *   { "threads": n,
+ *     "phases": { "class_table": { "usec": n, "calls": n }, "is_valid": ...,
+ *                 "init_class": ..., "type_check": ..., "check_classes": ... },
+ *     "counts": { "is_child": n, "lub": n, "get_formals": n,
+ *                 "get_return_type": n, "lookup_object": n },
+ *     "classes": [ { "name": "Main", "init_class_usec": n,
+ *                    "type_check_usec": n }, ... ] }
+ */
+void semant_profile::write_json(ostream& out) {
+    static const char *counter_names[PROFILE_COUNTERS] = {
+        "is_child", "lub", "get_formals", "get_return_type", "lookup_object"
+    };
+    out << "{\n  \"threads\": " << threads << ",\n  \"phases\": {\n";
+    write_phase(out, "class_table", class_table);
+    out << ",\n";
+    write_phase(out, "is_valid", is_valid);
+    out << ",\n";
+    write_phase(out, "init_class", init_class);
+    out << ",\n";
+    write_phase(out, "type_check", type_check);
+    out << ",\n";
+    write_phase(out, "check_classes", check_classes);
+    out << "\n  },\n  \"counts\": {\n";
+    for (int i = 0; i < PROFILE_COUNTERS; i++)
+        out << "    \"" << counter_names[i] << "\": " << counts[i]
+            << (i + 1 < PROFILE_COUNTERS ? ",\n" : "\n");
+    out << "  },\n  \"classes\": [";
+    for (size_t i = 0; i < classes.size(); i++)
+        out << (i > 0 ? ",\n" : "\n") << "    { \"name\": \"" << classes[i].name
+            << "\", \"init_class_usec\": " << classes[i].init_class_usec
+            << ", \"type_check_usec\": " << classes[i].type_check_usec << " }";
+    out << (classes.empty() ? "]\n}\n" : "\n  ]\n}\n");
+}
+
+/*
+ * One line of memo counts (see expr_memo), for COOL_SEMANT_MEMO=1:
+ *   memo: lookups=<n> hits=<n> hit_rate=<percent> reused_nodes=<n> stored=<n>
+ */
+static void print_memo_stats(ostream& out, const memo_stats& stats)
+{
+    double rate = stats.lookups > 0 ? 100.0 * stats.hits / stats.lookups : 0;
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.1f%%", rate);
+    out << "memo: lookups=" << stats.lookups << " hits=" << stats.hits
+        << " hit_rate=" << buf << " reused_nodes=" << stats.reused_nodes
+        << " stored=" << stats.stored << endl;
+}
+
+/*
+ * Writes the profile as JSON to the given file, or to standard error if
+ * that is "-".
+ */
+static void write_profile(const char *file, semant_profile& profile)
+{
+    if (strcmp(file, "-") == 0) {
+        profile.write_json(cerr);
+        return;
+    }
+    std::ofstream out(file);
+    if (!out)
+        cerr << "Could not write semant profile to " << file << endl;
+    else
+        profile.write_json(out);
+}
+
+/*
+ * The semant phase: checks the program with the options set by the flags
+ * and in the environment, reporting errors to cerr and exiting if there
+ * were any. The profile goes to the file given with -P; coolc-driver hands
+ * its flags to cgen, so it is asked for there with COOL_SEMANT_PROFILE.
+ */
+static void semant_phase(program_class *program, ostream *typed_out)
+{
+    const char *threads = getenv("COOL_SEMANT_THREADS");
+    const char *memo = getenv("COOL_SEMANT_MEMO");
+    const char *profile_file = semant_profile_file;
+    if (profile_file == NULL)
+        profile_file = getenv("COOL_SEMANT_PROFILE");
+    bool memoize = memo != NULL && atoi(memo) != 0;
+    memo_stats stats;
+    semant_profile profile;
+    int errors = program->semant(cerr, NULL, threads != NULL ? atoi(threads) : 1,
+                                 memoize ? &stats : NULL,
+                                 profile_file != NULL ? &profile : NULL, typed_out);
+    if (memoize)
+        print_memo_stats(cerr, stats);
+    if (profile_file != NULL)
+        write_profile(profile_file, profile);
+    if (errors != 0) {
+	cerr << "Compilation halted due to static semantic errors." << endl;
+	exit(1);
+    }
+}
+
 /*   This is the entry point to the semantic checker.
 
      Your checker should do the following two things:
@@ -454,33 +904,514 @@ bool ClassTable::check_method_signature(Symbol c1, Symbol c2, Symbol method_name
      to build mycoolc.
  */
 void program_class::semant()
+{
+    semant_phase(this, NULL);
+}
+
+/*
+ * semant() for phase drivers that pass the typed AST on: rather than
+ * leaving it to dump_with_types once every class is checked, each class is
+ * written to out, in program order, as soon as it and the classes before it
+ * have been checked, so the next phase can start on the first classes while
+ * the rest are checked. If there are errors, the classes before the first
+ * class with errors are followed by the line SEMANT_STREAM_HALTED, and
+ * semant exits with status 1 as usual.
+ */
+void program_class::semant_streaming(ostream& out)
+{
+    semant_phase(this, &out);
+}
+
+/*
+ * semant() for callers that check more than one program per process:
+ * errors go to err and the number of errors is returned instead of
+ * exiting. With a cache, classes whose results from the last run are still
+ * valid are not rechecked (see SemantCache in semant.h). Without one,
+ * classes are checked on the given number of threads (see check_classes),
+ * and with memo, the types of repeated subexpressions are reused and
+ * counted in memo (see expr_memo). The cache records which classes a check
+ * looked at, which a reused type would hide, so memo is ignored with one.
+ * With profile, the phases are timed and the calls the checks make to the
+ * class table and object map counted (see semant_profile). With typed_out,
+ * the typed AST is written there class by class, as semant_streaming
+ * describes, instead of being left to dump_with_types, and ends with
+ * SEMANT_STREAM_HALTED if there are errors.
+ * Programs that share no nodes can be checked on different threads, as
+ * long as each has its own cache.
+ */
+int program_class::semant(ostream& err, SemantCache *cache, int threads, memo_stats *memo,
+                          semant_profile *profile, ostream *typed_out)
 {
     initialize_constants();
 
     /* Initialize a new ClassTable inheritance graph and make sure it
        is well-formed. */
-    ClassTable *classtable = new ClassTable(classes);
-    if (!classtable->errors() && classtable->is_valid()) {
-        type_env_t env;
-        env.om = new SymbolTable<Symbol, Symbol>();
-        env.curr = NULL;
-        env.ct = classtable;
-
-        /* Recurisvely type check each class. */
-        for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
-            env.om->enterscope();
-            env.curr = classes->nth(i);
-            classes->nth(i)->init_class(env); // So the attributes are global
-                                              // in the class environment/scope
-            classes->nth(i)->type_check(env);
-            env.om->exitscope();
+    long start = profile != NULL ? semant_profile::now_usec() : 0;
+    ClassTable *classtable = new ClassTable(classes, err);
+    if (profile != NULL) {
+        profile->threads = threads;
+        profile->class_table.add(semant_profile::now_usec() - start);
+    }
+    if (cache == NULL)
+        classtable->set_memo_stats(memo);
+    classtable->set_profile(profile);
+
+    bool valid = false;
+    if (!classtable->errors()) {
+        start = profile != NULL ? semant_profile::now_usec() : 0;
+        valid = classtable->is_valid();
+        if (profile != NULL)
+            profile->is_valid.add(semant_profile::now_usec() - start);
+    }
+    if (valid) {
+        if (typed_out != NULL)
+            *typed_out << "#" << get_line_number() << "\n_program\n";
+        classtable->set_typed_output(typed_out);
+        start = profile != NULL ? semant_profile::now_usec() : 0;
+        check_classes(classtable, cache, threads);
+        if (profile != NULL)
+            profile->check_classes.add(semant_profile::now_usec() - start);
+    }
+    int errors = classtable->errors();
+    if (errors != 0 && typed_out != NULL)
+        *typed_out << SEMANT_STREAM_HALTED << endl;
+    delete classtable;
+    return errors;
+}
+
+/*
+ * Type checks a class in a fresh scope, in which its own attributes are
+ * checked (see init_class), timing both if profiling.
+ */
+static void check_class(type_env_t& env, Class_ c)
+{
+    semant_profile *profile = env.ct->get_profile();
+    class_profile p;
+    p.name = c->get_name();
+    long start = profile != NULL ? semant_profile::now_usec() : 0;
+
+    env.om->enterscope();
+    env.curr = c;
+    c->init_class(env); // So the attributes are global
+                        // in the class environment/scope
+    if (profile != NULL) {
+        long end = semant_profile::now_usec();
+        p.init_class_usec = end - start;
+        start = end;
+    }
+    c->type_check(env);
+    env.om->exitscope();
+
+    if (profile != NULL) {
+        p.type_check_usec = semant_profile::now_usec() - start;
+        profile->init_class.add(p.init_class_usec);
+        profile->type_check.add(p.type_check_usec);
+        profile->classes.push_back(p);
+    }
+}
+
+/*
+ * Type checks each class in turn. With a cache, a class whose previous
+ * results can be reused is skipped, and the results of every class checked
+ * are recorded. Without one, and with more than one thread, the classes
+ * are checked in parallel instead.
+ */
+void program_class::check_classes(ClassTable *classtable, SemantCache *cache, int threads)
+{
+    if (cache == NULL && threads > 1) {
+        check_classes_parallel(classtable, threads);
+        return;
+    }
+
+    type_env_t env;
+    env.om = new scoped_symbol_map<Symbol>();
+    env.curr = NULL;
+    env.ct = classtable;
+    expr_checker checker(env);
+    env.checker = &checker;
+    if (cache != NULL)
+        cache->begin(classtable);
+    classtable->build_method_tables();
+
+    /* Recurisvely type check each class. */
+    const std::vector<Class_>& program = classtable->get_program_classes();
+    for (size_t i = 0; i < program.size(); i++) {
+        Class_ c = program[i];
+        if (cache != NULL && cache->reuse(c)) {
+            classtable->write_typed(c);
+            continue;
         }
+        if (cache != NULL)
+            cache->begin_class(c);
+        check_class(env, c);
+        if (cache != NULL)
+            cache->end_class();
+        classtable->write_typed(c);
     }
 
-    if (classtable->errors()) {
-	cerr << "Compilation halted due to static semantic errors." << endl;
-	exit(1);
+    if (cache != NULL)
+        cache->end();
+    delete env.om;
+}
+
+/*
+ * Work for parallel checking. A class is split into tasks: one that checks
+ * its own attributes (init_class) and one per feature, in the order the
+ * sequential check takes them. Features can be checked apart because each
+ * method and attribute is checked in a scope of its own, and attributes
+ * are found through the class table (see lookup_object), so a class with
+ * many methods is spread over the workers like many classes are.
+ */
+struct check_task {
+    Class_ c;
+    Feature feature;            // NULL for the class's own attributes
+    size_t class_index;         // the class's place in the program
+};
+
+/*
+ * Each worker starts with a run of consecutive tasks in its queue and
+ * takes them from the front; a worker whose queue is empty steals from the
+ * back of another's, so one method that takes long to check doesn't hold
+ * up the tasks queued behind it. No work is added once checking starts, so
+ * a worker is done when every queue is empty.
+ */
+struct task_queue {
+    pthread_mutex_t lock;
+    std::deque<int> tasks;
+};
+
+struct check_pool {
+    ClassTable *ct;
+    std::vector<check_task> tasks;
+    std::vector<task_queue> queues;
+    std::vector<std::string> errors;    // indexed like tasks
+    std::vector<int> error_counts;
+    std::vector<long> usec;             // if profiling
+
+    // A class is finished when the last of its tasks is. The finished
+    // classes at the front of the program are merged: their errors are
+    // reported and their typed subtrees written, in program order.
+    std::vector<size_t> first_task;     // indexed by class
+    std::vector<int> unfinished_tasks;
+    std::vector<bool> finished;
+    size_t merged;                      // classes merged so far
+    pthread_mutex_t merge_lock;
+};
+
+/* Marks class i finished and merges every class it was holding up. */
+static void finish_class(check_pool& pool, size_t i)
+{
+    pthread_mutex_lock(&pool.merge_lock);
+    pool.finished[i] = true;
+    for (; pool.merged < pool.finished.size() && pool.finished[pool.merged]; pool.merged++) {
+        size_t end = pool.merged + 1 < pool.first_task.size() ?
+            pool.first_task[pool.merged + 1] : pool.tasks.size();
+        for (size_t task = pool.first_task[pool.merged]; task < end; task++)
+            pool.ct->merge_errors(pool.errors[task], pool.error_counts[task]);
+        pool.ct->write_typed(pool.tasks[end - 1].c);
+    }
+    pthread_mutex_unlock(&pool.merge_lock);
+}
+
+struct check_worker {
+    check_pool *pool;
+    size_t queue;
+};
+
+static bool take_task(check_pool& pool, size_t own, int& task)
+{
+    for (size_t i = 0; i < pool.queues.size(); i++) {
+        task_queue& q = pool.queues[(own + i) % pool.queues.size()];
+        pthread_mutex_lock(&q.lock);
+        bool found = !q.tasks.empty();
+        if (found && i == 0) {
+            task = q.tasks.front();
+            q.tasks.pop_front();
+        } else if (found) {
+            task = q.tasks.back();
+            q.tasks.pop_back();
+        }
+        pthread_mutex_unlock(&q.lock);
+        if (found)
+            return true;
     }
+    return false;
+}
+
+/*
+ * Runs tasks until there are none left, with an object map and expression
+ * checker of its own. The errors of each task are kept apart so that they
+ * can be merged in source order.
+ */
+static void *check_worker_main(void *arg)
+{
+    check_worker *worker = (check_worker *) arg;
+    check_pool& pool = *worker->pool;
+    type_env_t env;
+    env.om = new scoped_symbol_map<Symbol>();
+    env.curr = NULL;
+    env.ct = pool.ct;
+    expr_checker checker(env);
+    env.checker = &checker;
+
+    thread_errors errors;
+    ClassTable::set_thread_errors(&errors);
+    bool profiling = pool.ct->get_profile() != NULL;
+    int t;
+    while (take_task(pool, worker->queue, t)) {
+        errors.text.str("");
+        errors.count = 0;
+        long start = profiling ? semant_profile::now_usec() : 0;
+        env.curr = pool.tasks[t].c;
+        if (pool.tasks[t].feature == NULL)
+            env.curr->init_class(env);
+        else
+            pool.tasks[t].feature->type_check(env);
+        pool.errors[t] = errors.text.str();
+        pool.error_counts[t] = errors.count;
+        if (profiling)
+            pool.usec[t] = semant_profile::now_usec() - start;
+        size_t c = pool.tasks[t].class_index;
+        if (__sync_sub_and_fetch(&pool.unfinished_tasks[c], 1) == 0)
+            finish_class(pool, c);
+    }
+    ClassTable::set_thread_errors(NULL);
+    delete env.om;
+    return NULL;
+}
+
+/*
+ * Type checks the classes on a pool of threads. Once the class table is
+ * built and the method tables with it, checking a class only reads it, and
+ * writes nothing but the types of the class's own expressions. The errors
+ * come out as the sequential check would give them, each class's once it
+ * and the classes before it are done (see finish_class).
+ */
+void program_class::check_classes_parallel(ClassTable *classtable, int threads)
+{
+    check_pool pool;
+    pool.ct = classtable;
+    const std::vector<Class_>& program = classtable->get_program_classes();
+    for (size_t i = 0; i < program.size(); i++) {
+        check_task task;
+        task.c = program[i];
+        task.feature = NULL;
+        task.class_index = pool.first_task.size();
+        pool.first_task.push_back(pool.tasks.size());
+        pool.tasks.push_back(task);
+        Features features = task.c->get_features();
+        for (int j = features->first(); features->more(j); j = features->next(j)) {
+            task.feature = features->nth(j);
+            pool.tasks.push_back(task);
+        }
+        pool.unfinished_tasks.push_back(pool.tasks.size() - pool.first_task.back());
+    }
+    pool.finished.resize(pool.first_task.size());
+    pool.merged = 0;
+    pthread_mutex_init(&pool.merge_lock, NULL);
+    size_t n = pool.tasks.size();
+    if ((size_t) threads > n)
+        threads = n;
+    pool.queues.resize(threads);
+    for (int t = 0; t < threads; t++) {
+        pthread_mutex_init(&pool.queues[t].lock, NULL);
+        for (size_t task = t * n / threads; task < (t + 1) * n / threads; task++)
+            pool.queues[t].tasks.push_back(task);
+    }
+    pool.errors.resize(n);
+    pool.error_counts.resize(n);
+    if (classtable->get_profile() != NULL)
+        pool.usec.resize(n);
+    classtable->build_method_tables();
+
+    std::vector<pthread_t> ids(threads);
+    std::vector<check_worker> workers(threads);
+    for (int t = 0; t < threads; t++) {
+        workers[t].pool = &pool;
+        workers[t].queue = t;
+        pthread_create(&ids[t], NULL, check_worker_main, &workers[t]);
+    }
+    for (int t = 0; t < threads; t++)
+        pthread_join(ids[t], NULL);
+
+    for (int t = 0; t < threads; t++)
+        pthread_mutex_destroy(&pool.queues[t].lock);
+    pthread_mutex_destroy(&pool.merge_lock);
+
+    // Each class's tasks are consecutive, its init_class first.
+    semant_profile *profile = classtable->get_profile();
+    for (size_t task = 0; profile != NULL && task < n; ) {
+        class_profile p;
+        p.name = pool.tasks[task].c->get_name();
+        p.init_class_usec = pool.usec[task];
+        p.type_check_usec = 0;
+        for (task++; task < n && pool.tasks[task].feature != NULL; task++)
+            p.type_check_usec += pool.usec[task];
+        profile->init_class.add(p.init_class_usec);
+        profile->type_check.add(p.type_check_usec);
+        profile->classes.push_back(p);
+    }
+}
+
+/*
+ * SemantCache methods
+ */
+
+/* Starts a run: a change to the class hierarchy invalidates every entry. */
+void SemantCache::begin(ClassTable *ct)
+{
+    classtable = ct;
+    checked = reused = 0;
+    interfaces.clear();
+    duplicates.clear();
+    next_entries.clear();
+
+    std::vector<std::pair<Symbol, Symbol> > hierarchy;
+    std::set<Symbol> seen;
+    const std::vector<Class_>& program = ct->get_program_classes();
+    for (size_t i = 0; i < program.size(); i++) {
+        Class_ c = program[i];
+        hierarchy.push_back(std::make_pair(c->get_name(), c->get_parent()));
+        if (!seen.insert(c->get_name()).second)
+            duplicates.insert(c->get_name());
+    }
+    if (hierarchy != last_hierarchy) {
+        entries.clear();
+        last_hierarchy.swap(hierarchy);
+    }
+}
+
+/* The interface of class c in this run, computed once. */
+const std::string& SemantCache::interface(Symbol c)
+{
+    std::map<Symbol, std::string>::iterator iter = interfaces.find(c);
+    if (iter != interfaces.end())
+        return iter->second;
+    std::string& result = interfaces[c];
+    Class_ cl = classtable->class_exists(c) ? classtable->get_class(c) : NULL;
+    if (cl != NULL)
+        result = cl->get_interface();
+    return result;
+}
+
+/*
+ * Serializes class c with line numbers relative to the class and collects
+ * its nodes, so that it can be compared with, and take its types from, the
+ * version checked in an earlier run.
+ */
+void SemantCache::fingerprint(Class_ c)
+{
+    current = c;
+    current_nodes.clear();
+    current_exprs.clear();
+    writer.clear();
+    writer.relative_to(c->get_line_number());
+    writer.collect(&current_nodes);
+    c->dump_binary(writer);
+    writer.finish(current_ast);
+    for (size_t i = 0; i < current_nodes.size(); i++)
+        if (current_nodes[i].first >= AST_ASSIGN)
+            current_exprs.push_back(static_cast<Expression>(current_nodes[i].second));
+}
+
+/*
+ * Returns true, after copying the recorded types onto c and reporting the
+ * recorded errors, if c's results from the last run are still valid.
+ */
+bool SemantCache::reuse(Class_ c)
+{
+    fingerprint(c);
+    Symbol name = c->get_name();
+    std::map<Symbol, entry_t>::iterator iter = entries.find(name);
+    if (duplicates.count(name) || iter == entries.end() || iter->second.ast != current_ast)
+        return false;
+    entry_t& entry = iter->second;
+    for (std::map<Symbol, std::string>::iterator dep = entry.dep_interfaces.begin();
+         dep != entry.dep_interfaces.end(); ++dep) {
+        if (interface(dep->first) != dep->second)
+            return false;
+    }
+
+    for (size_t i = 0; i < current_exprs.size(); i++)
+        current_exprs[i]->set_type(entry.typed[i]->get_type());
+    entry.typed.swap(current_exprs);
+    replay(c, entry);
+    std::swap(next_entries[name], entry);
+    reused++;
+    return true;
+}
+
+/* Starts recording the check of the class last passed to reuse(). */
+void SemantCache::begin_class(Class_ c)
+{
+    capture.str("");
+    capture.clear();
+    captured.clear();
+    deps.clear();
+    classtable->start_capture(&capture, &captured, &deps);
+}
+
+/*
+ * Splits the captured output into errors, reports them and records the
+ * class's results. A class with an error positioned outside of it (an
+ * inherited attribute redefined, say) is not recorded, since the error's
+ * line would not follow that other class if it moved.
+ */
+void SemantCache::end_class()
+{
+    classtable->stop_capture();
+    checked++;
+
+    entry_t entry;
+    std::string text = capture.str();
+    int base = current->get_line_number();
+    std::set<tree_node *> own;
+    if (!captured.empty())
+        for (size_t i = 0; i < current_nodes.size(); i++)
+            own.insert(current_nodes[i].second);
+    bool reusable = duplicates.count(current->get_name()) == 0;
+    for (size_t i = 0; i < captured.size(); i++) {
+        size_t start = captured[i].pos;
+        size_t end = i + 1 < captured.size() ? (size_t) captured[i + 1].pos : text.size();
+        error_t e;
+        e.positioned = captured[i].node != NULL;
+        e.filename = captured[i].filename;
+        e.line = e.positioned ? captured[i].node->get_line_number() - base : 0;
+        e.text = text.substr(start, end - start);
+        if (e.positioned && own.count(captured[i].node) == 0)
+            reusable = false;
+        entry.errors.push_back(e);
+    }
+    replay(current, entry);
+
+    if (reusable) {
+        for (std::set<Symbol>::iterator dep = deps.begin(); dep != deps.end(); ++dep)
+            entry.dep_interfaces[*dep] = interface(*dep);
+        entry.ast.swap(current_ast);
+        entry.typed.swap(current_exprs);
+        std::swap(next_entries[current->get_name()], entry);
+    }
+}
+
+/* Reports the errors recorded for class c, at c's current position. */
+void SemantCache::replay(Class_ c, const entry_t& entry)
+{
+    for (size_t i = 0; i < entry.errors.size(); i++) {
+        const error_t& e = entry.errors[i];
+        ostream& err_stream = classtable->semant_error();
+        if (e.positioned)
+            err_stream << e.filename << ":" << e.line + c->get_line_number() << ": ";
+        err_stream << e.text;
+    }
+}
+
+/* Ends a run: only the classes seen in it are kept. */
+void SemantCache::end()
+{
+    entries.swap(next_entries);
+    next_entries.clear();
+    interfaces.clear();
+    classtable = NULL;
 }
 
 /*
@@ -495,20 +1426,35 @@ Symbol class__class::get_parent() {
     return parent;
 }
 
+Features class__class::get_features() {
+    return features;
+}
+
 /*
  * Initializes environment tables with class attributes.
- * Adds class attributes along the inheritance change,
- * adding parent class attributes first.
+ * The attributes a class defines and inherits are bound once for the whole
+ * program by the class table (see ClassTable::bind_attributes) and found
+ * through it when the object map has no local of the same name, so this
+ * only has to go over the class's own attributes.
  */
-void class__class::init_class(type_env_t env) {
-    if (name != Object) {
-        env.ct->get_class(parent)->init_class(env);
-    }
+void class__class::init_class(type_env_t& env) {
     for (int i = features->first(); features->more(i); i = features->next(i)) {
         features->nth(i)->add_to_environment(env);
     }
 }
 
+/*
+ * Returns the parts of the class other classes can depend on: its parent
+ * and the names and declared types of its features, as text.
+ */
+std::string class__class::get_interface() {
+    std::string interface = parent->get_string();
+    for (int i = features->first(); features->more(i); i = features->next(i)) {
+        features->nth(i)->add_to_interface(interface);
+    }
+    return interface;
+}
+
 /*
  * Gets the list of formals for a particular method of the class.
  * Returns NULL if the method isn't found.
@@ -551,11 +1497,31 @@ Symbol attr_class::get_return_type() { return NULL; }
 Symbol method_class::get_name() { return name; };
 Symbol attr_class::get_name() { return name; };
 
-void method_class::add_to_environment(type_env_t env) { /* Nothing to do */ }
-void attr_class::add_to_environment(type_env_t env) {
-    if (env.om->probe(name) == NULL)
-        env.om->addid(name, &type_decl);
-    else {
+Symbol method_class::get_type() { return return_type; }
+Symbol attr_class::get_type() { return type_decl; }
+
+void method_class::add_to_interface(std::string& interface) {
+    interface += " ";
+    interface += name->get_string();
+    interface += "(";
+    for (int i = formals->first(); formals->more(i); i = formals->next(i)) {
+        interface += formals->nth(i)->get_type()->get_string();
+        interface += ",";
+    }
+    interface += "):";
+    interface += return_type->get_string();
+}
+
+void attr_class::add_to_interface(std::string& interface) {
+    interface += " ";
+    interface += name->get_string();
+    interface += ":";
+    interface += type_decl->get_string();
+}
+
+void method_class::add_to_environment(type_env_t& env) { /* Nothing to do */ }
+void attr_class::add_to_environment(type_env_t& env) {
+    if (!env.ct->binds_attribute(env.curr->get_name(), this)) {
         ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
         err_stream << "Unable to add attribute " << name
                    << " to object map (already defined).\n";
@@ -565,11 +1531,30 @@ void attr_class::add_to_environment(type_env_t env) {
 Symbol formal_class::get_type() { return type_decl; }
 Symbol branch_class::get_type() { return type_decl; }
 
+/*
+ * Looks up an identifier in the object map O: the innermost local binding
+ * of it, or else the attribute of the current class.
+ */
+static Symbol *find_object(type_env_t& env, Symbol name) {
+    Symbol *type = env.om->lookup(name);
+    return type != NULL ? type : env.ct->lookup_attribute(env.curr->get_name(), name);
+}
+
+/*
+ * find_object for the checker's own lookups, which the profile counts.
+ * The memo probes its bindings with find_object directly, so that with
+ * the memo on the count only drops by the lookups its hits save.
+ */
+static Symbol *lookup_object(type_env_t& env, Symbol name) {
+    env.ct->profile_count(PROFILE_LOOKUP_OBJECT);
+    return find_object(env, name);
+}
+
 /*
  * Top-most step in recursive type checking. Recursively checks each of the
  * features (methods and attributes). Does not impose any type restrictions.
  */
-Class_ class__class::type_check(type_env_t env) {
+Class_ class__class::type_check(type_env_t& env) {
     for (int i = features->first(); features->more(i); i = features->next(i)) {
         features->nth(i)->type_check(env);
     }
@@ -586,10 +1571,10 @@ Class_ class__class::type_check(type_env_t env) {
  *    - Make sure the return type is a defined class (exists in the class table).
  *    - Make sure the return type is a subtype of the declared return type.
  */
-Feature method_class::type_check(type_env_t env) {
+Feature method_class::type_check(type_env_t& env) {
     env.om->enterscope();
     Symbol curr_class = env.curr->get_name();
-    env.om->addid(self, &curr_class);
+    env.om->addid(self, curr_class);
     for (int i = formals->first(); formals->more(i); i = formals->next(i)) {
         formals->nth(i)->type_check(env);
     }
@@ -635,10 +1620,10 @@ Feature method_class::type_check(type_env_t env) {
  * 2. Evaluate the initialization of the attribute.
  * 3. Make sure the initialized type is a subclass of the declared type.
  */
-Feature attr_class::type_check(type_env_t env) {
+Feature attr_class::type_check(type_env_t& env) {
     env.om->enterscope();
     Symbol curr_class = env.curr->get_name();
-    env.om->addid(self, &curr_class);
+    env.om->addid(self, curr_class);
     Symbol t1 = init->type_check(env)->type;
     env.om->exitscope();
     if (t1 == SELF_TYPE)
@@ -661,7 +1646,7 @@ Feature attr_class::type_check(type_env_t env) {
  * Type checks a formal parameter by making sure it hasn't already been defined in the
  * current scope.
  */
-Formal formal_class::type_check(type_env_t env) {
+Formal formal_class::type_check(type_env_t& env) {
     if (env.om->probe(name) != NULL) {
         ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
         err_stream << "Duplicate formal " << name << ".\n";
@@ -671,108 +1656,243 @@ Formal formal_class::type_check(type_env_t env) {
         err_stream << "Formal parameter " << name << " cannot have type SELF_TYPE\n";
     }
     else
-        env.om->addid(name, &type_decl);
+        env.om->addid(name, type_decl);
     return this;
 }
 
-/* Adds the branch to the environment. See typcase_class for more details. */
-Symbol branch_class::type_check(type_env_t env) {
-    // The following condition should never be true because a branch identifier
-    // is the first thing initialized in its own scope. This is just a sanity check.
-    if (env.om->probe(name) != NULL) {
-        ostream &err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "Identifier " << name << " already defined in current scope.\n";
-        return Object;
+/*
+ * Type checks an expression and everything in it (see expr_checker).
+ */
+Expression Expression_class::type_check(type_env_t& env) {
+    return env.checker->check(this);
+}
+
+expr_checker::expr_checker(type_env_t& env) : env(env), typcases(0), errors(0) {
+    stack.reserve(64);
+    arg_types.reserve(64);
+    branches.reserve(64);
+    memoizing = env.ct->memoizes();
+}
+
+expr_checker::~expr_checker() {
+    if (memoizing)
+        env.ct->add_memo_stats(memo.stats);
+}
+
+/*
+ * Checks e, running steps until its frame is popped.
+ */
+Expression expr_checker::check(Expression e) {
+    size_t bottom = stack.size();
+    if (memoizing)
+        memo.hash(e);
+    push(e);
+    while (stack.size() > bottom)
+        step();
+    return e;
+}
+
+void expr_checker::push(Expression e) {
+    frame f;
+    f.e = e;
+    f.step = 0;
+    f.i = 0;
+    f.t = NULL;
+    f.args = 0;
+    f.child = NULL;
+    f.keep = false;
+    f.errors = 0;
+    stack.push_back(f);
+}
+
+/*
+ * Pushes child, to be checked before f goes on with next_step. f may move
+ * when the stack grows, so the caller must return without touching it.
+ */
+void expr_checker::descend(frame& f, int next_step, Expression child) {
+    f.step = next_step;
+    f.child = child;
+    push(child);
+}
+
+/*
+ * Sets the type of the expression on top of the stack and pops it, keeping
+ * it in the memo if it was to be kept and no errors were found in it.
+ */
+void expr_checker::finish(Symbol type) {
+    frame& f = stack.back();
+    f.e->type = type;
+    if (f.keep && f.errors == errors)
+        memo.keep(f.e, env);
+    stack.pop_back();
+}
+
+ostream& expr_checker::error(tree_node *t) {
+    errors++;
+    return env.ct->semant_error(env.curr->get_filename(), t);
+}
+
+/*
+ * Takes the next step of the expression on top of the stack. Before its
+ * first step, an expression whose types the memo has is finished at once.
+ */
+void expr_checker::step() {
+    frame& f = stack.back();
+    Expression e = f.e;
+    if (memoizing && f.step == 0) {
+        if (memo.lookup(e, env, f.keep)) {
+            finish(e->type);
+            return;
+        }
+        f.errors = errors;
+    }
+    switch (e->get_tag()) {
+    case AST_ASSIGN:
+        check_assign(f, static_cast<assign_class *>(e));
+        break;
+    case AST_STATIC_DISPATCH:
+        check_static_dispatch(f, static_cast<static_dispatch_class *>(e));
+        break;
+    case AST_DISPATCH:
+        check_dispatch(f, static_cast<dispatch_class *>(e));
+        break;
+    case AST_COND:
+        check_cond(f, static_cast<cond_class *>(e));
+        break;
+    case AST_LOOP:
+        check_loop(f, static_cast<loop_class *>(e));
+        break;
+    case AST_TYPCASE:
+        check_typcase(f, static_cast<typcase_class *>(e));
+        break;
+    case AST_BLOCK:
+        check_block(f, static_cast<block_class *>(e));
+        break;
+    case AST_LET:
+        check_let(f, static_cast<let_class *>(e));
+        break;
+    case AST_PLUS: {
+        plus_class *op = static_cast<plus_class *>(e);
+        check_arith(f, op->e1, op->e2, "+", Int);
+        break;
+    }
+    case AST_SUB: {
+        sub_class *op = static_cast<sub_class *>(e);
+        check_arith(f, op->e1, op->e2, "-", Int);
+        break;
+    }
+    case AST_MUL: {
+        mul_class *op = static_cast<mul_class *>(e);
+        check_arith(f, op->e1, op->e2, "*", Int);
+        break;
+    }
+    case AST_DIVIDE: {
+        divide_class *op = static_cast<divide_class *>(e);
+        check_arith(f, op->e1, op->e2, "/", Int);
+        break;
+    }
+    case AST_LT: {
+        lt_class *op = static_cast<lt_class *>(e);
+        check_arith(f, op->e1, op->e2, "<", Bool);
+        break;
+    }
+    case AST_LEQ: {
+        leq_class *op = static_cast<leq_class *>(e);
+        check_arith(f, op->e1, op->e2, "<=", Bool);
+        break;
+    }
+    case AST_NEG:
+        check_unary(f, static_cast<neg_class *>(e)->e1, Int, "~");
+        break;
+    case AST_COMP:
+        check_unary(f, static_cast<comp_class *>(e)->e1, Bool, "!");
+        break;
+    case AST_EQ:
+        check_eq(f, static_cast<eq_class *>(e));
+        break;
+    case AST_ISVOID:
+        check_isvoid(f, static_cast<isvoid_class *>(e));
+        break;
+    case AST_NEW:
+        check_new(f, static_cast<new__class *>(e));
+        break;
+    case AST_OBJECT:
+        check_object(f, static_cast<object_class *>(e));
+        break;
+    /* Primitive constants */
+    case AST_INT_CONST:
+        finish(Int);
+        break;
+    case AST_BOOL_CONST:
+        finish(Bool);
+        break;
+    case AST_STRING_CONST:
+        finish(Str);
+        break;
+    case AST_NO_EXPR:
+        finish(No_type);
+        break;
+    default:
+        assert(!"not an expression");
     }
-    env.om->addid(name, &type_decl);
-    return expr->type_check(env)->type;
 }
 
 /*
  * Adds the identifier to the environment after checking its evaulated type
  * and making sure that's a subclass of the declared type.
  */
-Expression assign_class::type_check(type_env_t env) {
-    Symbol t1 = *env.om->lookup(name);
-    Symbol t2 = expr->type_check(env)->type;
-    if (t2 == SELF_TYPE) {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "Cannot assign to 'self'.\n";
-        type = Object;
+void expr_checker::check_assign(frame& f, assign_class *e) {
+    if (f.step == 0) {
+        Symbol *t1 = lookup_object(env, e->name);
+        f.t = t1 != NULL ? *t1 : NULL;
+        descend(f, 1, e->expr);
+        return;
+    }
+    Symbol t1 = f.t;
+    Symbol t2 = e->expr->type;
+    if (t1 == NULL) {
+        error(e) << "Assignment to undeclared variable " << e->name << ".\n";
+        finish(Object);
+    }
+    else if (t2 == SELF_TYPE) {
+        error(e) << "Cannot assign to 'self'.\n";
+        finish(Object);
     }
     else if (env.ct->is_child(t2, t1))
-        type = t2;
+        finish(t2);
     else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << t2 << " is not a subclass of " << t1 << ".\n";
-        type = Object;
+        error(e) << t2 << " is not a subclass of " << t1 << ".\n";
+        finish(Object);
     }
-    return this;
 }
 
 /*
- * Same as normal dispatch (see dispatch_class::type_check(type_env_t env) below),
- * with the additional condition that the evaluated type of the calling expression e
- * must be a subtype of the static class T in e@T.f(...).
+ * Same as normal dispatch (see check_dispatch below), with the additional
+ * condition that the evaluated type of the calling expression e must be a
+ * subtype of the static class T in e@T.f(...).
  */
-Expression static_dispatch_class::type_check(type_env_t env) {
-    std::vector<Symbol> eval_types; // Vector of parameter types after evaluation
-    Symbol t0 = expr->type_check(env)->type;
-    if (t0 == SELF_TYPE)
-        t0 = env.curr->get_name();
-    if (env.ct->is_child(t0, type_name)) {
-        for (int i = actual->first(); actual->more(i); i = actual->next(i)) {
-            Symbol tn = actual->nth(i)->type_check(env)->type;
-            if (tn == SELF_TYPE)
-                tn = env.curr->get_name();
-            eval_types.push_back(tn);
-        }
-        Formals formals = env.ct->get_formals(t0, name);     // Declared formal types
-        Symbol ret_type = env.ct->get_return_type(t0, name); // Declared return type
-        if (formals == NULL || ret_type == NULL) {
-            ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-            err_stream << "Dispatch to undefined method " << name << ".\n";
-            type = Object;
-            return this;
-        }
-        // Type check formal parameters
-        std::vector<Symbol>::iterator iter = eval_types.begin();
-        int fi = formals->first();
-        while (iter != eval_types.end() && formals->more(fi)) {
-            Symbol eval_type = *iter;
-            Symbol declared_type = formals->nth(fi)->get_type();
-            if (declared_type == SELF_TYPE) {
-                ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-                err_stream << "Formal parameter cannot have type SELF_TYPE.\n";
-            }
-            else if (!env.ct->is_child(eval_type, declared_type)) {
-                ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-                err_stream << "Formal parameter declared type " << declared_type
-                           << " is not a subclass of " << eval_type << ".\n";
-            }
-            ++iter;
-            fi = formals->next(fi);
-        }
-        if (iter != eval_types.end() || formals->more(fi)) {
-            // If we're here, means the number of parameters didn't match
-            // the expected number from the function definition. This should
-            // not be possible as long as lexing and parsing is correct.
-            ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-            err_stream << "Number of declared formals doesn't match number checked.\n";
-        }
-
-        if (ret_type == SELF_TYPE)
-            type = t0;
-        else
-            type = ret_type;
+void expr_checker::check_static_dispatch(frame& f, static_dispatch_class *e) {
+    if (f.step == 0) {
+        descend(f, 1, e->expr);
+        return;
     }
-    else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "Evaluated class " << t0 << " must be a child of declared class "
-                   << type_name << " in static dispatch.\n";
-        type = Object;
+    if (f.step == 1) {
+        Symbol t0 = e->expr->type;
+        if (t0 == SELF_TYPE)
+            t0 = env.curr->get_name();
+        if (!env.ct->is_child(t0, e->type_name)) {
+            error(e) << "Evaluated class " << t0 << " must be a child of declared class "
+                     << e->type_name << " in static dispatch.\n";
+            finish(Object);
+            return;
+        }
+        f.t = t0;
+        f.args = arg_types.size();
+        f.i = e->actual->first();
+        f.step = 2;
     }
-    return this;
+    if (check_actuals(f, e->actual))
+        check_call(f, e->name);
 }
 
 /*
@@ -785,95 +1905,126 @@ Expression static_dispatch_class::type_check(type_env_t env) {
  *    - The evaluated type if the declared type is SELF_TYPE.
  *    - The declared type otherwise.
  */
-Expression dispatch_class::type_check(type_env_t env) {
-    std::vector<Symbol> eval_types; // Vector of parameter types after evaluation
-    Symbol t0 = expr->type_check(env)->type;
-    Symbol curr = t0;
-    if (t0 == SELF_TYPE)
-        curr = env.curr->get_name();
-    for (int i = actual->first(); actual->more(i); i = actual->next(i)) {
-        Symbol tn = actual->nth(i)->type_check(env)->type;
+void expr_checker::check_dispatch(frame& f, dispatch_class *e) {
+    if (f.step == 0) {
+        descend(f, 1, e->expr);
+        return;
+    }
+    if (f.step == 1) {
+        f.t = e->expr->type;
+        f.args = arg_types.size();
+        f.i = e->actual->first();
+        f.step = 2;
+    }
+    if (check_actuals(f, e->actual))
+        check_call(f, e->name);
+}
+
+/*
+ * Checks the actual arguments of a dispatch one at a time, pushing their
+ * types on arg_types. Returns true once they have all been checked.
+ */
+bool expr_checker::check_actuals(frame& f, Expressions actual) {
+    if (f.step == 3) {
+        Symbol tn = f.child->type;
         if (tn == SELF_TYPE)
             tn = env.curr->get_name();
-        eval_types.push_back(tn);
+        arg_types.push_back(tn);
+        f.i = actual->next(f.i);
+    }
+    if (actual->more(f.i)) {
+        descend(f, 3, actual->nth(f.i));
+        return false;
     }
+    return true;
+}
+
+/*
+ * Steps 3 and 4 of dispatch, for the method name of the class f.t (the
+ * current class if it is SELF_TYPE), with the argument types on arg_types.
+ */
+void expr_checker::check_call(frame& f, Symbol name) {
+    Symbol t0 = f.t;
+    Symbol curr = t0 == SELF_TYPE ? env.curr->get_name() : t0;
     Formals formals = env.ct->get_formals(curr, name);     // Declared formal types
     Symbol ret_type = env.ct->get_return_type(curr, name); // Declared return type
     if (formals == NULL || ret_type == NULL) {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "Dispatch to undefined method " << name << ".\n";
-        type = Object;
-        return this;
+        error(f.e) << "Dispatch to undefined method " << name << ".\n";
+        arg_types.resize(f.args);
+        finish(Object);
+        return;
     }
- 
+
     // Type check formal parameters
-    std::vector<Symbol>::iterator iter = eval_types.begin();
+    size_t arg = f.args;
     int fi = formals->first();
-    while (iter != eval_types.end() && formals->more(fi)) {
-        Symbol eval_type = *iter;
+    while (arg < arg_types.size() && formals->more(fi)) {
+        Symbol eval_type = arg_types[arg];
         Symbol declared_type = formals->nth(fi)->get_type();
-        if (declared_type == SELF_TYPE) {
-            ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-            err_stream << "Formal parameter cannot have type SELF_TYPE.\n";
-        }
+        if (declared_type == SELF_TYPE)
+            error(f.e) << "Formal parameter cannot have type SELF_TYPE.\n";
         else if (!env.ct->is_child(eval_type, declared_type)) {
-            ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-            err_stream << "Formal parameter declared type " << declared_type
+            error(f.e) << "Formal parameter declared type " << declared_type
                        << " is not a subclass of " << eval_type << ".\n";
         }
-        ++iter;
+        arg++;
         fi = formals->next(fi);
     }
-    if (iter != eval_types.end() || formals->more(fi)) {
+    if (arg < arg_types.size() || formals->more(fi)) {
         // If we're here, means the number of parameters didn't match
         // the expected number from the function definition. This should
         // not be possible as long as lexing and parsing is correct.
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "Number of declared formals doesn't match number checked.\n";
+        error(f.e) << "Number of declared formals doesn't match number checked.\n";
     }
 
-    if (ret_type == SELF_TYPE)
-        type = t0;    
-    else
-        type = ret_type;
-    return this;
+    arg_types.resize(f.args);
+    finish(ret_type == SELF_TYPE ? t0 : ret_type);
 }
 
 /*
- * Recursively type checks the predicate, then the then expression, then the
- * else expression. Makes sure the predicate evaluates to Bool and returns
- * the least upper bound of the types of the other two expressions.
+ * Checks the predicate, then the then expression, then the else
+ * expression. Makes sure the predicate evaluates to Bool and returns the
+ * least upper bound of the types of the other two expressions.
  */
-Expression cond_class::type_check(type_env_t env) {
-    Symbol t1 = pred->type_check(env)->type;
-    Symbol t2 = then_exp->type_check(env)->type;
+void expr_checker::check_cond(frame& f, cond_class *e) {
+    switch (f.step) {
+    case 0:
+        descend(f, 1, e->pred);
+        return;
+    case 1:
+        descend(f, 2, e->then_exp);
+        return;
+    case 2:
+        descend(f, 3, e->else_exp);
+        return;
+    }
+    Symbol t2 = e->then_exp->type;
     if (t2 == SELF_TYPE)
         t2 = env.curr->get_name();
-    Symbol t3 = else_exp->type_check(env)->type;
+    Symbol t3 = e->else_exp->type;
     if (t3 == SELF_TYPE)
         t3 = env.curr->get_name();
-    if (t1 == Bool)
-        type = env.ct->lub(t2, t3);
+    if (e->pred->type == Bool)
+        finish(env.ct->lub(t2, t3));
     else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "If condition did not evaluate to a boolean.\n";
-        type = Object;
+        error(e) << "If condition did not evaluate to a boolean.\n";
+        finish(Object);
     }
-    return this;
 }
 
-/* Recurisvely type checks the predicate and body, makes sure predicate is a Bool. */
-Expression loop_class::type_check(type_env_t env) {
-    Symbol t1 = pred->type_check(env)->type;
-    Symbol t2 = body->type_check(env)->type;
-    if (t1 == Bool)
-        type = Object;
-    else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "While condition did not evaluate to a boolean.\n";
-        type = Object;
+/* Checks the predicate and body, makes sure predicate is a Bool. */
+void expr_checker::check_loop(frame& f, loop_class *e) {
+    switch (f.step) {
+    case 0:
+        descend(f, 1, e->pred);
+        return;
+    case 1:
+        descend(f, 2, e->body);
+        return;
     }
-    return this;
+    if (e->pred->type != Bool)
+        error(e) << "While condition did not evaluate to a boolean.\n";
+    finish(Object);
 }
 
 /*
@@ -881,44 +2032,106 @@ Expression loop_class::type_check(type_env_t env) {
  * case e0 of x1:T1=>e1, ..., xn:Tn=>en esac
  * For each branch i, the current identifier xi is saved in a new scope and the
  * expression ei is evaluated. The typcase class evaluates the the least upper
- * bound of the evaluated types.
- */
-Expression typcase_class::type_check(type_env_t env) {
-    Symbol t0 = expr->type_check(env)->type;
-
-    // O(N^2) check to make sure there are no duplicate types.
-    for (int i = cases->first(); cases->more(i); i = cases->next(i)) {
-        for (int j = cases->first(); cases->more(j); j = cases->next(j)) {
-            if (i != j && cases->nth(i)->get_type() == cases->nth(j)->get_type()) {
-                ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-                err_stream << "Duplicate branch " << cases->nth(i)->get_type()
-                           << " in case statement.\n";
-                type = Object;
-                return this;
-            }
+ * bound of the evaluated types. The first branch is bound in the enclosing
+ * scope rather than a new one.
+ * The branches are copied onto the branches stack first, since taking the
+ * nth element of a list costs time linear in n.
+ */
+void expr_checker::check_typcase(frame& f, typcase_class *e) {
+    Cases cases = e->cases;
+    if (f.step == 0) {
+        descend(f, 1, e->expr);
+        return;
+    }
+    if (f.step == 1) {
+        f.args = branches.size();
+        for (int i = cases->first(); cases->more(i); i = cases->next(i))
+            branches.push_back(static_cast<branch_class *>(cases->nth(i)));
+        if (report_duplicate_branches(f.args)) {
+            branches.resize(f.args);
+            finish(Object);
+            return;
         }
+        f.i = f.args;
+        f.step = 2;
     }
 
-    Symbol tn = cases->nth(cases->first())->type_check(env);
-    for (int i = cases->first(); cases->more(i); i = cases->next(i)) {
-        if (i != cases->first()) {
-            env.om->enterscope();
-            tn = env.ct->lub(tn, cases->nth(i)->type_check(env));
+    for (;;) {
+        Symbol tn;
+        if (f.step == 3)
+            tn = f.child->type;
+        else {
+            // Any case nested in the branches has popped its own by now.
+            if ((size_t) f.i == branches.size()) {
+                branches.resize(f.args);
+                finish(f.t);
+                return;
+            }
+            branch_class *branch = branches[f.i];
+            if ((size_t) f.i != f.args)
+                env.om->enterscope();
+            // The following condition can only be true for the first branch,
+            // which isn't checked in a scope of its own.
+            if (env.om->probe(branch->name) != NULL) {
+                errors++;
+                ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), branch);
+                err_stream << "Identifier " << branch->name << " already defined in current scope.\n";
+                tn = Object;
+            }
+            else {
+                env.om->addid(branch->name, branch->type_decl);
+                descend(f, 3, branch->expr);
+                return;
+            }
+        }
+        if ((size_t) f.i == f.args)
+            f.t = tn;
+        else {
+            f.t = env.ct->lub(f.t, tn);
             env.om->exitscope();
         }
+        f.i++;
+        f.step = 2;
     }
-    type = tn;
-    return this;
+}
+
+/*
+ * Reports every branch of a case (the branches from first on the branches
+ * stack) declared with the same type as an earlier branch, at the
+ * duplicate's own line. Returns true if there were any. The branches are
+ * counted by type in branch_counts, whose counts are stamped with the case
+ * they belong to, so that the table never needs clearing.
+ */
+bool expr_checker::report_duplicate_branches(size_t first) {
+    int stamp = ++typcases;
+    bool duplicates = false;
+    for (size_t i = first; i < branches.size(); i++) {
+        branch_count& c = branch_counts[branches[i]->type_decl];
+        if (c.stamp != stamp) {
+            c.stamp = stamp;
+            c.count = 0;
+        }
+        if (++c.count > 1) {
+            error(branches[i]) << "Duplicate branch " << branches[i]->type_decl
+                               << " in case statement.\n";
+            duplicates = true;
+        }
+    }
+    return duplicates;
 }
 
 /* Type checks each enclosing expression. Imposes no type conditions. */
-Expression block_class::type_check(type_env_t env) {
-    Symbol t1;
-    for (int i = body->first(); body->more(i); i = body->next(i)) {
-        t1 = body->nth(i)->type_check(env)->type;
+void expr_checker::check_block(frame& f, block_class *e) {
+    if (f.step == 0)
+        f.i = e->body->first();
+    else {
+        f.t = f.child->type;
+        f.i = e->body->next(f.i);
     }
-    type = t1;
-    return this;
+    if (e->body->more(f.i))
+        descend(f, 1, e->body->nth(f.i));
+    else
+        finish(f.t);
 }
 
 /*
@@ -929,215 +2142,400 @@ Expression block_class::type_check(type_env_t env) {
  * 3. Enters a new environment scope with the identifier x bound to the declared
  *    type T0.
  * 4. Typechecks the body e2, and the type evaluates to the evaluated type T2.
+ * A multi-binding let arrives as a chain of nested let nodes, each of which
+ * gets the type of the innermost body, or Object if one of the bindings
+ * failed (in which case nothing inside it is checked).
  */
-Expression let_class::type_check(type_env_t env) {
-    if (identifier == self) {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "'self' cannot be bound in a 'let' expression.\n";
-        type = Object;
-    }
-    else {
-        Symbol t0 = type_decl;
-        Symbol t1 = init->type_check(env)->type;
-        // No init
-        if (t1 == No_type) {
-            env.om->enterscope();
-            env.om->addid(identifier, &t0);
-            Symbol t2 = body->type_check(env)->type;
-            env.om->exitscope();
-            type = t2;
+void expr_checker::check_let(frame& f, let_class *e) {
+    if (f.step == 0) {
+        if (e->identifier == self) {
+            error(e) << "'self' cannot be bound in a 'let' expression.\n";
+            finish(Object);
+            return;
         }
+        descend(f, 1, e->init);
+        return;
+    }
+    if (f.step == 1) {
+        Symbol t1 = e->init->type;
         // With init
-        else {
-            if (env.ct->is_child(t1, t0)) {
-                env.om->enterscope();
-                env.om->addid(identifier, &t0);
-                Symbol t2 = body->type_check(env)->type;
-                env.om->exitscope();
-                type = t2;
-            }
-            else {
-                ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-                err_stream << "Expression must evaluate to a child of " << t0 << ".\n";
-                type = Object;
-            }
+        if (t1 != No_type && !env.ct->is_child(t1, e->type_decl)) {
+            error(e) << "Expression must evaluate to a child of " << e->type_decl << ".\n";
+            finish(Object);
+            return;
         }
+        env.om->enterscope();
+        env.om->addid(e->identifier, e->type_decl);
+        descend(f, 2, e->body);
+        return;
     }
-    return this;
+    env.om->exitscope();
+    finish(e->body->type);
 }
 
 /*
  * The following arithmetic classes are self-explanatory:
  * +, -, *, /, ~, <, =, !
  */
-Expression plus_class::type_check(type_env_t env) {
-    Symbol t1 = e1->type_check(env)->type;
-    Symbol t2 = e2->type_check(env)->type;
-    if (t1 == Int && t2 == Int)
-        type = Int;
-    else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "non-Int arguments " << t1 << " + " << t2 << ".\n";
-        type = Object;
+void expr_checker::check_arith(frame& f, Expression e1, Expression e2, const char *op, Symbol result) {
+    switch (f.step) {
+    case 0:
+        descend(f, 1, e1);
+        return;
+    case 1:
+        descend(f, 2, e2);
+        return;
     }
-    return this;
-}
-
-Expression sub_class::type_check(type_env_t env) {
-    Symbol t1 = e1->type_check(env)->type;
-    Symbol t2 = e2->type_check(env)->type;
+    Symbol t1 = e1->type;
+    Symbol t2 = e2->type;
     if (t1 == Int && t2 == Int)
-        type = Int;
+        finish(result);
     else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "non-Int arguments " << t1 << " - " << t2 << ".\n";
-        type = Object;
+        error(f.e) << "non-Int arguments " << t1 << " " << op << " " << t2 << ".\n";
+        finish(Object);
     }
-    return this;
 }
 
-Expression mul_class::type_check(type_env_t env) {
-    Symbol t1 = e1->type_check(env)->type;
-    Symbol t2 = e2->type_check(env)->type;
-    if (t1 == Int && t2 == Int)
-        type = Int;
-    else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "non-Int arguments " << t1 << " * " << t2 << ".\n";
-        type = Object;
-    }
-    return this;
-}
-
-Expression divide_class::type_check(type_env_t env) {
-    Symbol t1 = e1->type_check(env)->type;
-    Symbol t2 = e2->type_check(env)->type;
-    if (t1 == Int && t2 == Int)
-        type = Int;
-    else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "non-Int arguments " << t1 << " / " << t2 << ".\n";
-        type = Object;
+void expr_checker::check_unary(frame& f, Expression e1, Symbol operand, const char *op) {
+    if (f.step == 0) {
+        descend(f, 1, e1);
+        return;
     }
-    return this;
-}
-
-Expression neg_class::type_check(type_env_t env) {
-    Symbol t1 = e1->type_check(env)->type;
-    if (t1 == Int)
-        type = Int;
+    Symbol t1 = e1->type;
+    if (t1 == operand)
+        finish(operand);
     else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "non-Int argument ~" << t1 << ".\n";
-        type = Object;
+        error(f.e) << "non-" << operand << " argument " << op << t1 << ".\n";
+        finish(Object);
     }
-    return this;
 }
 
-Expression lt_class::type_check(type_env_t env) {
-    Symbol t1 = e1->type_check(env)->type;
-    Symbol t2 = e2->type_check(env)->type;
-    if (t1 == Int && t2 == Int)
-        type = Bool;
-    else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "non-Int arguments " << t1 << " < " << t2 << ".\n";
-        type = Object;
+void expr_checker::check_eq(frame& f, eq_class *e) {
+    switch (f.step) {
+    case 0:
+        descend(f, 1, e->e1);
+        return;
+    case 1:
+        descend(f, 2, e->e2);
+        return;
     }
-    return this;
-}
-
-Expression eq_class::type_check(type_env_t env) {
-    Symbol t1 = e1->type_check(env)->type;
-    Symbol t2 = e2->type_check(env)->type;
+    Symbol t1 = e->e1->type;
+    Symbol t2 = e->e2->type;
     // Any comparison is legal, except: if one argument is in {Int, Str, Bool},
     // the other must match.
     if ((t1 == Int && t2 != Int) || (t1 != Int && t2 == Int) ||
         (t1 == Str && t2 != Str) || (t1 != Str && t2 == Str) ||
         (t1 == Bool && t2 != Bool) || (t1 != Bool && t2 == Bool)) {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "Cannot compare arguments " << t1 << " = " << t2 << ".\n";
-        type = Object;
+        error(e) << "Cannot compare arguments " << t1 << " = " << t2 << ".\n";
+        finish(Object);
     }
-    else {
-        type = Bool;
-    }
-    return this;
+    else
+        finish(Bool);
 }
 
-Expression leq_class::type_check(type_env_t env) {
-    Symbol t1 = e1->type_check(env)->type;
-    Symbol t2 = e2->type_check(env)->type;
-    if (t1 == Int && t2 == Int)
-        type = Bool;
+void expr_checker::check_isvoid(frame& f, isvoid_class *e) {
+    if (f.step == 0)
+        descend(f, 1, e->e1);
+    else
+        finish(Bool);
+}
+
+void expr_checker::check_new(frame& f, new__class *e) {
+    if (env.ct->class_exists(e->type_name) || e->type_name == SELF_TYPE)
+        finish(e->type_name);
     else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "non-Int arguments " << t1 << " <= " << t2 << ".\n";
-        type = Object;
+        error(e) << "'new' used with undefined class " << e->type_name << ".\n";
+        finish(Object);
     }
-    return this;
 }
 
-Expression comp_class::type_check(type_env_t env) {
-    Symbol t1 = e1->type_check(env)->type;
-    if (t1 == Bool)
-        type = Bool;
+void expr_checker::check_object(frame& f, object_class *e) {
+    Symbol *type = e->name == self ? NULL : lookup_object(env, e->name);
+    if (e->name == self)
+        finish(SELF_TYPE);
+    else if (type != NULL)
+        finish(*type);
     else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "non-Bool argument !" << t1 << ".\n";
-        type = Object;
+        error(e) << "Could not find identifier " << e->name << " in current scope.\n";
+        finish(Object);
     }
-    return this;
 }
 
-/* Primitive constants */
-Expression int_const_class::type_check(type_env_t env) {
-    type = Int;
-    return this;
-}
+/*
+ * expr_memo methods
+ */
 
-Expression bool_const_class::type_check(type_env_t env) {
-    type = Bool;
-    return this;
-}
+// Expressions smaller than this are checked again rather than looked up.
+static const int memo_min_size = 4;
 
-Expression string_const_class::type_check(type_env_t env) {
-    type = Str;
-    return this;
+// Tried for each shape and class before giving up on keeping more.
+static const size_t memo_max_kept = 4;
+
+/*
+ * Appends the names and constants of e to words and its subexpressions to
+ * children, in a fixed order.
+ */
+void expr_memo::parts(Expression e, std::vector<size_t>& words, std::vector<Expression>& children) {
+    words.push_back(e->get_tag());
+    switch (e->get_tag()) {
+    case AST_ASSIGN: {
+        assign_class *a = static_cast<assign_class *>(e);
+        words.push_back((size_t) a->name);
+        children.push_back(a->expr);
+        break;
+    }
+    case AST_STATIC_DISPATCH: {
+        static_dispatch_class *d = static_cast<static_dispatch_class *>(e);
+        words.push_back((size_t) d->type_name);
+        words.push_back((size_t) d->name);
+        children.push_back(d->expr);
+        for (int i = d->actual->first(); d->actual->more(i); i = d->actual->next(i))
+            children.push_back(d->actual->nth(i));
+        break;
+    }
+    case AST_DISPATCH: {
+        dispatch_class *d = static_cast<dispatch_class *>(e);
+        words.push_back((size_t) d->name);
+        children.push_back(d->expr);
+        for (int i = d->actual->first(); d->actual->more(i); i = d->actual->next(i))
+            children.push_back(d->actual->nth(i));
+        break;
+    }
+    case AST_COND: {
+        cond_class *c = static_cast<cond_class *>(e);
+        children.push_back(c->pred);
+        children.push_back(c->then_exp);
+        children.push_back(c->else_exp);
+        break;
+    }
+    case AST_LOOP: {
+        loop_class *l = static_cast<loop_class *>(e);
+        children.push_back(l->pred);
+        children.push_back(l->body);
+        break;
+    }
+    case AST_TYPCASE: {
+        typcase_class *c = static_cast<typcase_class *>(e);
+        children.push_back(c->expr);
+        for (int i = c->cases->first(); c->cases->more(i); i = c->cases->next(i)) {
+            branch_class *b = static_cast<branch_class *>(c->cases->nth(i));
+            words.push_back((size_t) b->name);
+            words.push_back((size_t) b->type_decl);
+            children.push_back(b->expr);
+        }
+        break;
+    }
+    case AST_BLOCK: {
+        block_class *b = static_cast<block_class *>(e);
+        for (int i = b->body->first(); b->body->more(i); i = b->body->next(i))
+            children.push_back(b->body->nth(i));
+        break;
+    }
+    case AST_LET: {
+        let_class *l = static_cast<let_class *>(e);
+        words.push_back((size_t) l->identifier);
+        words.push_back((size_t) l->type_decl);
+        children.push_back(l->init);
+        children.push_back(l->body);
+        break;
+    }
+    case AST_PLUS:
+        children.push_back(static_cast<plus_class *>(e)->e1);
+        children.push_back(static_cast<plus_class *>(e)->e2);
+        break;
+    case AST_SUB:
+        children.push_back(static_cast<sub_class *>(e)->e1);
+        children.push_back(static_cast<sub_class *>(e)->e2);
+        break;
+    case AST_MUL:
+        children.push_back(static_cast<mul_class *>(e)->e1);
+        children.push_back(static_cast<mul_class *>(e)->e2);
+        break;
+    case AST_DIVIDE:
+        children.push_back(static_cast<divide_class *>(e)->e1);
+        children.push_back(static_cast<divide_class *>(e)->e2);
+        break;
+    case AST_LT:
+        children.push_back(static_cast<lt_class *>(e)->e1);
+        children.push_back(static_cast<lt_class *>(e)->e2);
+        break;
+    case AST_EQ:
+        children.push_back(static_cast<eq_class *>(e)->e1);
+        children.push_back(static_cast<eq_class *>(e)->e2);
+        break;
+    case AST_LEQ:
+        children.push_back(static_cast<leq_class *>(e)->e1);
+        children.push_back(static_cast<leq_class *>(e)->e2);
+        break;
+    case AST_NEG:
+        children.push_back(static_cast<neg_class *>(e)->e1);
+        break;
+    case AST_COMP:
+        children.push_back(static_cast<comp_class *>(e)->e1);
+        break;
+    case AST_ISVOID:
+        children.push_back(static_cast<isvoid_class *>(e)->e1);
+        break;
+    case AST_INT_CONST:
+        words.push_back((size_t) static_cast<int_const_class *>(e)->token);
+        break;
+    case AST_BOOL_CONST:
+        words.push_back((size_t) static_cast<bool_const_class *>(e)->val);
+        break;
+    case AST_STRING_CONST:
+        words.push_back((size_t) static_cast<string_const_class *>(e)->token);
+        break;
+    case AST_NEW:
+        words.push_back((size_t) static_cast<new__class *>(e)->type_name);
+        break;
+    case AST_OBJECT:
+        words.push_back((size_t) static_cast<object_class *>(e)->name);
+        break;
+    default:
+        break;
+    }
 }
 
-Expression new__class::type_check(type_env_t env) {
-    if (env.ct->class_exists(type_name) || type_name == SELF_TYPE)
-        type = type_name;
-    else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "'new' used with undefined class " << type_name << ".\n";
-        type = Object;
+/*
+ * Hashes the shape of every expression in root. The expressions are
+ * listed parents first, each with where its words and children are, and
+ * hashed in the reverse order, so that the children of each are hashed
+ * before it.
+ */
+void expr_memo::hash(Expression root) {
+    if (seen.empty())
+        seen.resize(1 << 16);   // on first use: every checker has a memo, used or not
+    work.clear();
+    words.clear();
+    spans.clear();
+    work.push_back(root);
+    for (size_t i = 0; i < work.size(); i++) {
+        span sp;
+        sp.words = words.size();
+        sp.children = work.size();
+        parts(work[i], words, work);
+        sp.words_end = words.size();
+        sp.children_end = work.size();
+        spans.push_back(sp);
     }
-    return this;
+    for (size_t i = work.size(); i-- > 0; ) {
+        const span& sp = spans[i];
+        shape s;
+        s.hash = 2166136261u;
+        s.size = 1;
+        s.has_case = work[i]->get_tag() == AST_TYPCASE;
+        for (size_t w = sp.words; w < sp.words_end; w++)
+            s.hash = (s.hash ^ (unsigned) (words[w] ^ (words[w] >> 16 >> 16))) * 16777619u;
+        for (size_t c = sp.children; c < sp.children_end; c++) {
+            shape *cs = shapes.find(work[c]);
+            s.hash = (s.hash ^ cs->hash) * 16777619u;
+            s.size += cs->size;
+            s.has_case = s.has_case || cs->has_case;
+        }
+        shapes[work[i]] = s;
+    }
+    work.clear();
 }
 
-Expression isvoid_class::type_check(type_env_t env) {
-    Symbol t1 = e1->type_check(env)->type;
-    type = Bool;
-    return this;
+/*
+ * Lists the identifiers that e uses or assigns, with the types they are
+ * bound to in env. Identifiers that e binds itself are listed too, with
+ * whatever they are bound to outside it; that only makes a match less
+ * likely, never wrong.
+ */
+void expr_memo::bindings(Expression e, type_env_t& env, std::vector<std::pair<Symbol, Symbol> >& out) {
+    work.clear();
+    work.push_back(e);
+    for (size_t i = 0; i < work.size(); i++) {
+        Expression n = work[i];
+        Symbol name = NULL;
+        if (n->get_tag() == AST_OBJECT)
+            name = static_cast<object_class *>(n)->name;
+        else if (n->get_tag() == AST_ASSIGN)
+            name = static_cast<assign_class *>(n)->name;
+        if (name != NULL) {
+            bool listed = false;
+            for (size_t j = 0; j < out.size() && !listed; j++)
+                listed = out[j].first == name;
+            if (!listed) {
+                Symbol *type = find_object(env, name);
+                out.push_back(std::make_pair(name, type != NULL ? *type : (Symbol) NULL));
+            }
+        }
+        parts(n, words, work);
+        words.clear();
+    }
+    work.clear();
 }
 
-Expression no_expr_class::type_check(type_env_t env) {
-    type = No_type;
-    return this;
+/*
+ * Copies the types of from onto to, which must have the same shape.
+ * Returns false if it turns out not to (the hashes of the two collided),
+ * in which case to is left partly typed.
+ */
+bool expr_memo::copy_types(Expression from, Expression to) {
+    pairs.clear();
+    pairs.push_back(std::make_pair(from, to));
+    while (!pairs.empty()) {
+        Expression a = pairs.back().first;
+        Expression b = pairs.back().second;
+        pairs.pop_back();
+        words.clear();
+        other_words.clear();
+        children.clear();
+        other_children.clear();
+        parts(a, words, children);
+        parts(b, other_words, other_children);
+        if (words != other_words || children.size() != other_children.size())
+            return false;
+        b->type = a->type;
+        for (size_t i = 0; i < children.size(); i++)
+            pairs.push_back(std::make_pair(children[i], other_children[i]));
+    }
+    return true;
 }
 
-Expression object_class::type_check(type_env_t env) {
-    if (name == self)
-        type = SELF_TYPE;
-    else if (env.om->lookup(name) != NULL)
-        type = *(env.om->lookup(name));
-    else {
-        ostream& err_stream = env.ct->semant_error(env.curr->get_filename(), this);
-        err_stream << "Could not find identifier " << name << " in current scope.\n";
-        type = Object;
+/*
+ * Looks e up. Returns true if its types were copied from an expression
+ * kept earlier; otherwise sets keep if it should be kept once checked.
+ */
+bool expr_memo::lookup(Expression e, type_env_t& env, bool& keep) {
+    keep = false;
+    shape *s = shapes.find(e);
+    if (s == NULL || s->size < memo_min_size || s->has_case)
+        return false;
+    stats.lookups++;
+    Symbol c = env.curr->get_name();
+    size_t bit = (s->hash ^ (size_t) c >> 4) & (seen.size() - 1);
+    if (!seen[bit]) {
+        seen[bit] = true;
+        return false;
     }
-    return this;
+    entry& en = entries[std::make_pair(s->hash, c)];
+    for (size_t i = 0; i < en.kept_exprs.size(); i++) {
+        kept& k = en.kept_exprs[i];
+        bool same = true;
+        for (size_t j = 0; j < k.bindings.size() && same; j++) {
+            Symbol *type = find_object(env, k.bindings[j].first);
+            same = (type != NULL ? *type : (Symbol) NULL) == k.bindings[j].second;
+        }
+        if (same && copy_types(k.e, e)) {
+            stats.hits++;
+            stats.reused_nodes += s->size;
+            return true;
+        }
+    }
+    keep = en.kept_exprs.size() < memo_max_kept;
+    return false;
 }
 
+/* Keeps e, just checked without errors in env, for reuse. */
+void expr_memo::keep(Expression e, type_env_t& env) {
+    shape *s = shapes.find(e);
+    entry& en = entries[std::make_pair(s->hash, env.curr->get_name())];
+    en.kept_exprs.push_back(kept());
+    kept& k = en.kept_exprs.back();
+    k.e = e;
+    bindings(e, env, k.bindings);
+    stats.stored++;
+}
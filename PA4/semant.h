@@ -3,9 +3,13 @@
 
 #include <assert.h>
 #include <iostream>  
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
 #include "cool-tree.h"
 #include "stringtab.h"
-#include "symtab.h"
 #include "list.h"
 
 #define TRUE 1
@@ -14,33 +18,305 @@
 class ClassTable;
 typedef ClassTable *ClassTableP;
 
+/*
+ * Hash table from Symbols to T, for the lookups made for every expression.
+ * Symbols are interned, so keys are hashed and compared by address. Open
+ * addressing keeps the entries in one array; a NULL key marks a free slot.
+ * The array is allocated on the first insertion, so an empty map costs
+ * nothing. Other pointers than Symbols can be keys, through K.
+ */
+template <class T, class K = Symbol>
+class symbol_map {
+private:
+  std::vector<std::pair<K, T> > slots;     // size is a power of two
+  size_t used;
+
+  size_t slot_of(K s) const {
+    size_t h = (size_t) s >> 4;
+    h ^= h >> 16;
+    return (h * 0x9e3779b1u) & (slots.size() - 1);
+  }
+  void grow() {
+    std::vector<std::pair<K, T> > old(slots.empty() ? 16 : slots.size() * 2);
+    old.swap(slots);
+    for (size_t i = 0; i < old.size(); i++) {
+      if (old[i].first == NULL)
+        continue;
+      size_t j = slot_of(old[i].first);
+      while (slots[j].first != NULL)
+        j = (j + 1) & (slots.size() - 1);
+      slots[j] = old[i];
+    }
+  }
+
+public:
+  symbol_map() : used(0) { }
+
+  T *find(K s) {
+    if (slots.empty())
+      return NULL;
+    for (size_t i = slot_of(s); slots[i].first != NULL; i = (i + 1) & (slots.size() - 1))
+      if (slots[i].first == s)
+        return &slots[i].second;
+    return NULL;
+  }
+  T& operator[](K s) {
+    T *value = find(s);
+    if (value != NULL)
+      return *value;
+    if ((used + 1) * 4 > slots.size() * 3)
+      grow();
+    size_t i = slot_of(s);
+    while (slots[i].first != NULL)
+      i = (i + 1) & (slots.size() - 1);
+    slots[i].first = s;
+    used++;
+    return slots[i].second;
+  }
+};
+
+/*
+ * Scoped symbol table with the interface of SymbolTable<Symbol, T> (see
+ * symtab.h), used for the object map, except that values are stored by
+ * value: addid copies the value in, and lookup and probe return a pointer
+ * to the copy, valid until the next addid or exitscope.
+ * SymbolTable searches a list of scopes, each a list of bindings, so a
+ * lookup costs as much as the number of bindings in scope. Here bindings
+ * live in one array, innermost last, each with the index of the binding of
+ * the same name it shadows, and a symbol_map holds the innermost binding
+ * of every name, so lookup and probe are one hash lookup. A scope is the
+ * tail of the array from where it was entered, which exitscope pops. The
+ * array and the map only grow, so once they are large enough for the
+ * deepest scope nothing is allocated.
+ */
+template <class T>
+class scoped_symbol_map {
+private:
+  struct binding {
+    Symbol name;
+    T value;
+    int shadowed;               // index of the outer binding of name, or -1
+  };
+  std::vector<binding> bindings;
+  symbol_map<int> innermost;            // -1 if the name is not bound
+  std::vector<size_t> scope_starts;     // bindings.size() at each enterscope
+
+  int innermost_index(Symbol s) {
+    int *i = innermost.find(s);
+    return i != NULL ? *i : -1;
+  }
+
+public:
+  void enterscope() { scope_starts.push_back(bindings.size()); }
+  void exitscope() {
+    assert(!scope_starts.empty());
+    while (bindings.size() > scope_starts.back()) {
+      *innermost.find(bindings.back().name) = bindings.back().shadowed;
+      bindings.pop_back();
+    }
+    scope_starts.pop_back();
+  }
+  void addid(Symbol s, T value) {
+    assert(!scope_starts.empty());
+    binding b;
+    b.name = s;
+    b.value = value;
+    b.shadowed = innermost_index(s);
+    innermost[s] = bindings.size();
+    bindings.push_back(b);
+  }
+  T *lookup(Symbol s) {
+    int i = innermost_index(s);
+    return i >= 0 ? &bindings[i].value : NULL;
+  }
+  T *probe(Symbol s) {
+    int i = innermost_index(s);
+    return i >= 0 && (size_t) i >= scope_starts.back() ? &bindings[i].value : NULL;
+  }
+};
+
+// A method as seen from a class that defines or inherits it.
+struct method_info {
+    Symbol defined_in;
+    Formals formals;
+    Symbol return_type;
+
+    method_info() : defined_in(NULL), formals(NULL), return_type(NULL) { }
+};
+typedef symbol_map<method_info> method_table;
+
+// An attribute as seen from the class that defines it and its descendants.
+struct attr_binding {
+    int class_id;               // the defining class
+    Feature attr;
+    Symbol type_decl;
+};
+
+// Counts kept while subexpression types are memoized (see expr_memo).
+struct memo_stats {
+    long lookups;               // expressions looked up
+    long hits;                  // expressions whose types were reused
+    long reused_nodes;          // nodes typed by those hits
+    long stored;                // expressions kept for reuse
+
+    memo_stats() : lookups(0), hits(0), reused_nodes(0), stored(0) { }
+    void add(const memo_stats& s) {
+      lookups += s.lookups;
+      hits += s.hits;
+      reused_nodes += s.reused_nodes;
+      stored += s.stored;
+    }
+};
+
+// What semant_profile counts calls to.
+enum profile_counter {
+    PROFILE_IS_CHILD,
+    PROFILE_LUB,
+    PROFILE_GET_FORMALS,
+    PROFILE_GET_RETURN_TYPE,
+    PROFILE_LOOKUP_OBJECT,      // identifiers the checker looks up (not the memo)
+    PROFILE_COUNTERS
+};
+
+// Time spent in one phase of semant, over all calls.
+struct profile_phase {
+    long usec;
+    long calls;
+
+    profile_phase() : usec(0), calls(0) { }
+    void add(long u) { usec += u; calls++; }
+};
+
+// Time spent checking one class.
+struct class_profile {
+    Symbol name;
+    long init_class_usec;
+    long type_check_usec;       // over all its features, if checked in parallel
+};
+
+/*
+ * Wall times and call counts of semantic analysis, kept when semant is
+ * given one (-P, see program_class::semant). Calls are counted from every
+ * thread checking classes, hence the atomic increment.
+ */
+struct semant_profile {
+    int threads;
+    profile_phase class_table;  // ClassTable construction
+    profile_phase is_valid;
+    profile_phase init_class;   // per class
+    profile_phase type_check;   // per class
+    profile_phase check_classes;
+    long counts[PROFILE_COUNTERS];
+    std::vector<class_profile> classes;         // in the order checked
+
+    semant_profile();
+    void count(profile_counter c) { __sync_fetch_and_add(&counts[c], 1); }
+    void write_json(ostream& out);
+    static long now_usec();
+};
+
+// The errors of a thread checking classes in parallel with others (see
+// program_class::check_classes_parallel).
+struct thread_errors {
+    std::ostringstream text;
+    int count;
+};
+
+// An error reported while SemantCache is recording a class (see below).
+struct captured_error {
+    std::streampos pos;         // where its text starts in the capture buffer
+    Symbol filename;            // NULL for errors without a position
+    tree_node *node;
+};
+
+// The last line of a streamed typed AST (see program_class::semant_streaming)
+// when semant found errors. The AST reader rejects it, so a phase reading
+// the stream fails instead of taking the classes written before the errors
+// for the whole program.
+#define SEMANT_STREAM_HALTED "#halted: static semantic errors"
+
 /*
  * This clas is used to check class and method inheritance and to print errors
  * encountered in semantic analysis. In type checking, it functions as the method
  * mapping M.
- * It contains a class map <class name, Class_ pointer> and an inheritance graph
- * <class name, parent class name>. The inheritance graph is constructed and
- * verified to ensure that the class declarations are valid (e.g., no cycles
- * in the inheritance tree). During type checking, helper methods use these maps
- * to get method definitions and check method inheritance.
+ * Each class gets a dense ID when it is added, and the class pointers and the
+ * inheritance graph <class ID, parent> are kept in arrays indexed by ID. The
+ * inheritance graph is constructed and verified to ensure that the class
+ * declarations are valid (e.g., no cycles in the inheritance tree). During
+ * type checking, helper methods use these arrays to get method definitions,
+ * check method inheritance and find the attributes a class sees.
  * See semant.cc for more details.
  */
 class ClassTable {
 private:
   int semant_errors;
   void install_basic_classes();
-  ostream& error_stream;
-  std::map<Symbol, Class_> class_map;         // Maps class names to the class pointers
-  std::map<Symbol, Symbol> inheritance_graph; // Maps child classes to parents
+  static Classes build_basic_classes();
+  ostream *error_stream;
+  symbol_map<int> class_ids;          // Maps class names to class IDs
+  std::vector<Class_> program_classes; // the program's classes, in order
+  int class_id(Symbol c) { int *id = class_ids.find(c); return id != NULL ? *id : -1; }
+
+  // Indexed by class ID
+  std::vector<Class_> class_by_id;
+  std::vector<Symbol> parent_by_id;   // the inheritance graph
+  std::vector<int> parent_id;         // -1 for Object; set by is_valid
+  std::vector<int> depth;             // from Object, set by is_valid
+  std::vector<int> preorder;          // DFS numbers, set by is_valid
+  std::vector<int> postorder;
+  std::vector<size_t> tour_first;     // first visit in euler_tour
+  std::vector<method_table> method_tables;   // flattened, see build_method_tables
+  std::vector<int> method_table_of;   // index into method_tables
+
+  std::vector<int> euler_tour;        // class IDs in DFS order
+  std::vector<std::vector<int> > tour_min;   // sparse table for lub
+
+  // The attributes bound under each name, one per subtree of classes that
+  // sees them, in preorder. The subtrees are disjoint, since a class cannot
+  // redefine an attribute it inherits.
+  symbol_map<std::vector<attr_binding> > attributes;
+  attr_binding *find_attribute(int id, Symbol attr_name);
+  void bind_attributes();
+
+  method_table& get_method_table(int id);
+  const method_info *find_method(int id, Symbol method_name);
+  void number_classes();
+
+  // Set while SemantCache records a class: errors are written to capture
+  // (and counted when SemantCache replays them), and every class whose
+  // features the check looks at is added to deps.
+  std::ostringstream *capture;
+  std::vector<captured_error> *captured;
+  std::set<Symbol> *deps;
+  void depends_on(Symbol c) { if (deps != NULL) deps->insert(c); }
+
+  memo_stats *memo;                   // NULL unless memoizing, see expr_memo
+  semant_profile *profile;            // NULL unless profiling
+  ostream *typed_out;                 // NULL unless streaming the typed AST
 
 public:
-  ClassTable(Classes);
+  ClassTable(Classes, ostream& err = cerr);
   int errors() { return semant_errors; }
+  const std::vector<Class_>& get_program_classes() { return program_classes; }
+  void start_capture(std::ostringstream *buf, std::vector<captured_error> *errs,
+                     std::set<Symbol> *d) { capture = buf; captured = errs; deps = d; }
+  void stop_capture() { capture = NULL; captured = NULL; deps = NULL; }
+  void set_memo_stats(memo_stats *stats) { memo = stats; }
+  bool memoizes() { return memo != NULL; }
+  void add_memo_stats(const memo_stats& stats);
+  void set_profile(semant_profile *p) { profile = p; }
+  semant_profile *get_profile() { return profile; }
+  void profile_count(profile_counter c) { if (profile != NULL) profile->count(c); }
+  void set_typed_output(ostream *out) { typed_out = out; }
+  void write_typed(Class_ c);
   ostream& semant_error();
   ostream& semant_error(Class_ c);
   ostream& semant_error(Symbol filename, tree_node *t);
+  static void set_thread_errors(thread_errors *errors);
+  void merge_errors(const std::string& text, int count);
   void add_to_class_table(Class_ c);
   bool is_valid();
+  void build_method_tables();
   Symbol lub(Symbol c1, Symbol c2);
   bool is_child(Symbol child, Symbol parent);
   bool class_exists(Symbol c);
@@ -49,6 +325,205 @@ public:
   Symbol get_return_type(Symbol class_name, Symbol method_name);
   Symbol get_ancestor_method_class(Symbol class_name, Symbol method_name);
   bool check_method_signature(Symbol c1, Symbol c2, Symbol method_name);
+  Symbol *lookup_attribute(Symbol class_name, Symbol attr_name);
+  bool binds_attribute(Symbol class_name, Feature attr);
+};
+
+/*
+ * Memo of the types of subexpressions, for programs (generated ones in
+ * particular) that repeat the same subexpressions. Expressions are hashed
+ * by shape: their kind, names, constants and the shapes of their children.
+ * The type checker looks an expression up before checking it. A hit is an
+ * expression of the same shape, checked earlier by the same checker in the
+ * same class, whose identifiers were bound to the same types then as they
+ * are now; its types are copied over the expression and the check is
+ * skipped. Since types come only from the shape, the current class and
+ * those bindings, the expression would have been given the same ones.
+ * Only expressions checked without errors are kept, and not before their
+ * shape has been seen once, so that a program without repeats pays for
+ * little more than the hashing. Expressions containing a case are left
+ * alone: the first branch of a case is bound in the enclosing scope (see
+ * check_typcase), which skipping the check would leave out.
+ */
+class expr_memo {
+private:
+  struct shape {
+    unsigned hash;
+    int size;                   // nodes
+    bool has_case;
+  };
+  struct kept {
+    Expression e;
+    std::vector<std::pair<Symbol, Symbol> > bindings;   // identifier, type
+  };
+  struct entry {
+    std::vector<kept> kept_exprs;
+  };
+  struct span {                 // of an expression's parts, see hash
+    size_t words, words_end;
+    size_t children, children_end;
+  };
+  symbol_map<shape, Expression> shapes;
+  // Shapes are entered on their second sighting; seen, indexed by hash
+  // and class, marks the first (or, on a collision, some other shape's).
+  std::vector<bool> seen;
+  std::map<std::pair<unsigned, Symbol>, entry> entries;  // by hash and class
+  std::vector<Expression> work;
+  std::vector<span> spans;
+  std::vector<std::pair<Expression, Expression> > pairs;
+  std::vector<size_t> words, other_words;
+  std::vector<Expression> children, other_children;
+
+  void parts(Expression e, std::vector<size_t>& words, std::vector<Expression>& children);
+  bool copy_types(Expression from, Expression to);
+  void bindings(Expression e, type_env_t& env, std::vector<std::pair<Symbol, Symbol> >& out);
+
+public:
+  memo_stats stats;
+
+  expr_memo() { }
+  void hash(Expression root);
+  bool lookup(Expression e, type_env_t& env, bool& keep);
+  void keep(Expression e, type_env_t& env);
+};
+
+/*
+ * Type checker for expressions. Rather than have each expression check its
+ * subexpressions by calling itself, which takes a native stack frame per
+ * level of nesting (and overflows on a long enough chain of +, or of nested
+ * lets and blocks), the checker keeps a stack of the expressions it is in
+ * the middle of. Each frame records how far its expression has got; a step
+ * either pushes the next subexpression or, once they are all typed, applies
+ * the typing rule, sets the expression's type and pops the frame. The
+ * expressions come out with the types and errors the rules give in
+ * semant.cc, in the order a recursive checker would give them.
+ *
+ * One checker serves every expression checked in an environment (see
+ * type_env_t::checker) and sees the environment's current class as it
+ * changes. Its stacks keep their capacity from one expression to the next,
+ * so once they have grown to the deepest expression and the most arguments
+ * pending at once, checking allocates nothing.
+ */
+class expr_checker {
+private:
+  struct frame {
+    Expression e;
+    int step;
+    int i;                      // position in the expression's list
+    Symbol t;                   // carried from one step to the next
+    size_t args;                // where its argument types start in arg_types,
+                                // or its branches in branches
+    Expression child;           // the subexpression pushed last
+    bool keep;                  // to be kept in memo if checked without errors
+    int errors;                 // errors before it was checked
+  };
+  struct branch_count {
+    int stamp;                  // the case counted, see report_duplicate_branches
+    int count;
+
+    branch_count() : stamp(0), count(0) { }
+  };
+  type_env_t& env;
+  std::vector<frame> stack;
+  std::vector<Symbol> arg_types;        // of the dispatches on the stack
+  std::vector<branch_class *> branches; // of the cases on the stack
+  symbol_map<branch_count> branch_counts;
+  int typcases;                         // cases checked so far
+  int errors;                           // reported so far
+  bool memoizing;                       // if the class table memoizes
+  expr_memo memo;
+
+  void push(Expression e);
+  void descend(frame& f, int next_step, Expression child);
+  void finish(Symbol type);
+  ostream& error(tree_node *t);
+  void step();
+  void check_assign(frame& f, assign_class *e);
+  void check_static_dispatch(frame& f, static_dispatch_class *e);
+  void check_dispatch(frame& f, dispatch_class *e);
+  bool check_actuals(frame& f, Expressions actual);
+  void check_call(frame& f, Symbol name);
+  void check_cond(frame& f, cond_class *e);
+  void check_loop(frame& f, loop_class *e);
+  void check_typcase(frame& f, typcase_class *e);
+  bool report_duplicate_branches(size_t first);
+  void check_block(frame& f, block_class *e);
+  void check_let(frame& f, let_class *e);
+  void check_arith(frame& f, Expression e1, Expression e2, const char *op, Symbol result);
+  void check_unary(frame& f, Expression e1, Symbol operand, const char *op);
+  void check_eq(frame& f, eq_class *e);
+  void check_isvoid(frame& f, isvoid_class *e);
+  void check_new(frame& f, new__class *e);
+  void check_object(frame& f, object_class *e);
+
+public:
+  expr_checker(type_env_t& env);
+  ~expr_checker();
+  Expression check(Expression e);
+};
+
+/*
+ * Results of semantic analysis kept from one run to the next, so that
+ * program_class::semant(ostream&, SemantCache*) only rechecks the classes an
+ * edit could have affected. For every class checked it records
+ *   - the class's AST, with line numbers relative to the class, to tell
+ *     whether the class itself changed (a class that only moved still
+ *     matches, and its results are shifted to the new lines);
+ *   - the interfaces (parent and feature signatures) of every class the
+ *     check looked at: the ancestors it inherits attributes and methods
+ *     from and the classes it dispatches to;
+ *   - its errors and the types it assigned.
+ * A class is reused when it is unchanged and so are the interfaces of all
+ * of those classes. Any change to the class hierarchy itself (a class
+ * added, removed, renamed or reparented) rechecks everything, since lub
+ * and conformance depend on the whole graph.
+ */
+class SemantCache {
+private:
+  struct error_t {
+    bool positioned;            // printed with a filename:line: prefix
+    Symbol filename;
+    int line;                   // relative to the class's line
+    std::string text;
+  };
+  struct entry_t {
+    std::string ast;
+    std::map<Symbol, std::string> dep_interfaces;
+    std::vector<Expression> typed;      // expressions in preorder, with types
+    std::vector<error_t> errors;
+  };
+  std::vector<std::pair<Symbol, Symbol> > last_hierarchy;
+  std::map<Symbol, entry_t> entries;
+
+  // State for the current run
+  ClassTable *classtable;
+  std::map<Symbol, std::string> interfaces;
+  std::set<Symbol> duplicates;
+  std::map<Symbol, entry_t> next_entries;
+  Class_ current;
+  std::string current_ast;
+  ast_writer writer;            // kept from class to class for its memory
+  std::vector<Expression> current_exprs;
+  std::vector<std::pair<ast_tag, tree_node *> > current_nodes;
+  std::ostringstream capture;
+  std::vector<captured_error> captured;
+  std::set<Symbol> deps;
+
+  const std::string& interface(Symbol c);
+  void fingerprint(Class_ c);
+  void replay(Class_ c, const entry_t& entry);
+
+public:
+  int checked;                  // classes checked in the last run
+  int reused;                   // classes whose results were reused
+
+  SemantCache() : classtable(NULL), current(NULL), checked(0), reused(0) { }
+
+  void begin(ClassTable *ct);
+  bool reuse(Class_ c);
+  void begin_class(Class_ c);
+  void end_class();
+  void end();
 };
 
 